@@ -0,0 +1,15 @@
+#!/usr/bin/ruby
+
+# Generates a synthetic script with one long flat scope, to benchmark how the
+# executer walks the node tree. Usage:
+#   ruby flat-benchmark.rb [statements] > flat-benchmark.turtle
+#   time kturtle --test flat-benchmark.turtle
+
+statements = (ARGV[0] || 100000).to_i
+
+puts "kturtle-script-v1.0"
+puts "@(reset)"
+(statements / 2).times do |i|
+  puts "@(forward) #{i % 100}"
+  puts "@(turnright) 91"
+end
@@ -0,0 +1,86 @@
+#  Copyright (C) 2026 by agent
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public
+#  License as published by the Free Software Foundation; either
+#  version 2 of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public
+#  License along with this program; if not, write to the Free
+#  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+#  Boston, MA 02110-1301, USA.
+
+require File.dirname(__FILE__) + '/spec_helper.rb'
+$i = Interpreter.instance
+
+describe "bytecode" do
+  # every example is run compiled and walked, with the same results
+
+  it "should assign like the tree walker" do
+    code = <<-EOS
+      $x = 1
+      $y = $x + 1
+      $x = "kturtle"
+      assert $x == "kturtle"
+      assert $y == 2
+    EOS
+    $i.errors_of(code, :compiling => false).should == []
+    $i.errors_of(code, :compiling => true).should == []
+  end
+
+  it "should not execute the expressions of a loop again after a break" do
+    code = <<-EOS
+      $n = 0
+      learn count {
+        $n = $n + 1
+        return 1
+      }
+      while count > 0 {
+        break
+      }
+      repeat count {
+        break
+      }
+      for $i = count to 5 {
+        if $i == 1 {
+          break
+        }
+      }
+      assert $n == 3
+    EOS
+    $i.errors_of(code, :compiling => false).should == []
+    $i.errors_of(code, :compiling => true).should == []
+  end
+
+  it "should ignore a break outside a loop" do
+    code = <<-EOS
+      learn stop {
+        break
+      }
+      break
+      $x = 0
+      repeat 3 {
+        $x = $x + 1
+        stop
+      }
+      assert $x == 3
+    EOS
+    $i.errors_of(code, :compiling => false).should == []
+    $i.errors_of(code, :compiling => true).should == []
+  end
+
+  it "should report the same errors as the tree walker" do
+    code = <<-EOS
+      assert $unassigned == 1
+      repeat "kturtle" { }
+    EOS
+    walked = $i.errors_of(code, :compiling => false)
+    walked.should_not == []
+    $i.errors_of(code, :compiling => true).should == walked
+  end
+end
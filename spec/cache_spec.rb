@@ -0,0 +1,65 @@
+#  Copyright (C) 2026 by agent
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public
+#  License as published by the Free Software Foundation; either
+#  version 2 of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public
+#  License along with this program; if not, write to the Free
+#  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+#  Boston, MA 02110-1301, USA.
+
+require File.dirname(__FILE__) + '/spec_helper.rb'
+$i = Interpreter.instance
+
+describe "running the same code again (parse tree cache)" do
+
+  # a comment makes the code differ from that of the previous runs
+  def fresh(code); "# #{Time.now.to_f}\n" + code; end
+
+  it "should run the same code again without parsing, with the same results" do
+    code = fresh <<-EOS
+      learn double $x {
+        return $x * 2
+      }
+      $x = 0
+      repeat 3 {
+        $x = $x + (double 1)
+      }
+      assert $x == 6
+    EOS
+    $i.load code
+    $i.cached?.should be_false
+    $i.run(code).errors.should == []
+    $i.load code
+    $i.cached?.should be_true
+    $i.run(code).errors.should == []
+  end
+
+  it "should give the same error messages when running the same code again" do
+    code = fresh "$x = 1\n$y = $x / 0\n"
+    first = $i.run(code).errors
+    first.should_not be_empty
+    $i.load code
+    $i.cached?.should be_true
+    $i.run(code).errors.should == first
+  end
+
+  it "should parse again when the code or the passes change" do
+    code = fresh "assert 1 + 1 == 2\n"
+    $i.should_run_clean code
+    $i.with(:optimizing => false) do
+      $i.load code
+      $i.cached?.should be_false
+      $i.should_run_clean code
+    end
+    $i.load code + "assert true\n"
+    $i.cached?.should be_false
+  end
+end
@@ -0,0 +1,76 @@
+#  Copyright (C) 2026 by agent
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public
+#  License as published by the Free Software Foundation; either
+#  version 2 of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public
+#  License along with this program; if not, write to the Free
+#  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+#  Boston, MA 02110-1301, USA.
+
+require File.dirname(__FILE__) + '/spec_helper.rb'
+$i = Interpreter.instance
+
+describe "inlining learned functions" do
+
+  it "should give the same results with --inline as without" do
+    code = <<-EOS
+      learn double $x {
+        return $x * 2
+      }
+      learn check $x, $y {
+        assert $x == $y
+      }
+      assert (double 21) == 42
+      $a = 4
+      assert (double $a) == 8
+      check (double 1), 2
+      check "kturtle", "kturtle"
+      for $n = 1 to 3 {
+        assert (double $n) == $n + $n
+      }
+    EOS
+    $i.errors_of(code).should == []
+    $i.errors_of(code, :inlining => true).should == []
+  end
+
+  it "should give the same error messages with --inline as without" do
+    [ "learn double $x {\n  return $x * 2\n}\n$y = double \"kturtle\"",
+      "learn half $x {\n  return $x / 0\n}\n$y = half 1",
+      "learn check $x {\n  assert $x\n}\ncheck false"
+    ].each do |code|
+      errors = $i.errors_of(code)
+      errors.should_not be_empty
+      errors.should == $i.errors_of(code, :inlining => true)
+    end
+  end
+
+  it "should leave the functions that can not be inlined alone" do
+    code = <<-EOS
+      $count = 0
+      learn tick {
+        $count = $count + 1
+      }
+      learn fac $n {
+        if $n < 2 {
+          return 1
+        }
+        return $n * (fac $n - 1)
+      }
+      tick
+      tick
+      assert $count == 2
+      assert (fac 5) == 120
+      assert (fac 2 + 1) == 6
+    EOS
+    $i.errors_of(code).should == []
+    $i.errors_of(code, :inlining => true).should == []
+  end
+end
@@ -0,0 +1,80 @@
+#  Copyright (C) 2026 by agent
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public
+#  License as published by the Free Software Foundation; either
+#  version 2 of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public
+#  License along with this program; if not, write to the Free
+#  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+#  Boston, MA 02110-1301, USA.
+
+require File.dirname(__FILE__) + '/spec_helper.rb'
+$i = Interpreter.instance
+
+describe "memoizing learned functions" do
+
+  it "should give the same results for a pure function memoized and not" do
+    code = <<-EOS
+      learn fib $n {
+        if $n < 2 {
+          return $n
+        }
+        return (fib $n - 1) + (fib $n - 2)
+      }
+      assert (fib 20) == 6765
+      assert (fib 20) == 6765
+      assert (fib 1) == 1
+    EOS
+    $i.errors_of(code, :memoizing => false).should == []
+    $i.errors_of(code).should == []
+  end
+
+  it "should not remember a function that reads a global" do
+    code = <<-EOS
+      $factor = 2
+      learn scale $x {
+        return $x * $factor
+      }
+      assert (scale 3) == 6
+      $factor = 3
+      assert (scale 3) == 9
+    EOS
+    $i.errors_of(code, :memoizing => false).should == []
+    $i.errors_of(code).should == []
+  end
+
+  it "should not remember a function that assigns a global" do
+    code = <<-EOS
+      $count = 0
+      learn add $x {
+        $count = $count + $x
+        return $count
+      }
+      assert (add 2) == 2
+      assert (add 2) == 4
+      assert $count == 4
+    EOS
+    $i.errors_of(code, :memoizing => false).should == []
+    $i.errors_of(code).should == []
+  end
+
+  it "should give the same error messages memoized and not" do
+    code = <<-EOS
+      learn half $x {
+        return $x / 0
+      }
+      $y = half 1
+      $y = half 1
+    EOS
+    errors = $i.errors_of(code)
+    errors.should_not be_empty
+    errors.should == $i.errors_of(code, :memoizing => false)
+  end
+end
@@ -0,0 +1,130 @@
+#  Copyright (C) 2026 by agent
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public
+#  License as published by the Free Software Foundation; either
+#  version 2 of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public
+#  License along with this program; if not, write to the Free
+#  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+#  Boston, MA 02110-1301, USA.
+
+require File.dirname(__FILE__) + '/spec_helper.rb'
+$i = Interpreter.instance
+
+describe "optimizer (constant folding and dead branches)" do
+
+  it "should give the same results folded and not folded" do
+    code = <<-EOS
+      assert 1 + 2 * 3 == 7
+      assert (1 + 2) * 3 == 9
+      assert 2 ^ -2 == 0.25
+      assert -3 ^ 3 == -27
+      assert 7 / 2 == 3.5
+      assert (sqrt 16) == 4
+      assert (round -1.5) == -2
+      assert (cos 0) == 1
+      assert 1 < 2 and not (2 < 1)
+      assert "kturtle" == "kturtle"
+      $x = 2 * 3
+      assert $x + 1 == 7
+    EOS
+    $i.errors_of(code, :optimizing => false).should == []
+    $i.errors_of(code).should == []
+  end
+
+  it "should give the same error messages folded and not folded" do
+    [ '$x = 1 / 0',
+      '$x = sqrt -1',
+      '$x = 10 ^ 400',
+      '$x = 10 ^ -400',
+      '$x = "kturtle" + 1',
+      '$x = 1 - true'
+    ].each do |code|
+      folded = $i.errors_of(code)
+      folded.should == $i.errors_of(code, :optimizing => false)
+    end
+    $i.errors_of('$x = 1 / 0').should_not be_empty
+  end
+
+  it "should give the same results for if with a literal condition, optimized or not" do
+    code = <<-EOS
+      $x = 0
+      if true {
+        $x = 1
+      } else {
+        assert false
+      }
+      if false {
+        assert false
+      } else {
+        $x = $x + 1
+      }
+      if false {
+        assert false
+      }
+      assert $x == 2
+    EOS
+    $i.errors_of(code, :optimizing => false).should == []
+    $i.errors_of(code).should == []
+  end
+
+  it "should give the same results for else if with a literal condition, optimized or not" do
+    code = <<-EOS
+      $x = 0
+      if false {
+        assert false
+      } else if true {
+        $x = 1
+      } else {
+        assert false
+      }
+      if false {
+        assert false
+      } else if false {
+        assert false
+      } else {
+        $x = $x + 1
+      }
+      assert $x == 2
+    EOS
+    $i.errors_of(code, :optimizing => false).should == []
+    $i.errors_of(code).should == []
+  end
+
+  it "should give the same results for while with a literal condition, optimized or not" do
+    code = <<-EOS
+      while false {
+        assert false
+      }
+      $x = 0
+      while true {
+        $x = $x + 1
+        if $x == 3 {
+          break
+        }
+      }
+      assert $x == 3
+    EOS
+    $i.errors_of(code, :optimizing => false).should == []
+    $i.errors_of(code).should == []
+  end
+
+  it "should give the same results for literal conditions that are not in a scope, optimized or not" do
+    code = <<-EOS
+      $x = 0
+      repeat 2 {
+        if true { $x = $x + 1 }
+      }
+      assert $x == 2
+    EOS
+    $i.errors_of(code, :optimizing => false).should == []
+    $i.errors_of(code).should == []
+  end
+end
@@ -20,10 +20,30 @@ $i = Interpreter.instance
 
 describe "scopes" do
   it "should allow empty scopes" do
-    true.should_not be_true
-    # empty scopes currenty hang the interpreter
-    # so do scopes without a flow/learn statement
-    # TODO fix this. (without the fix the other tests are useless)
+    [false, true].each do |compiling|
+      $i.errors_of(<<-EOS, :compiling => compiling).should == []
+        { }
+        repeat 2 { }
+        assert true
+      EOS
+    end
+  end
+
+  it "should execute a scope without a flow/learn statement once" do
+    [false, true].each do |compiling|
+      $i.errors_of(<<-EOS, :compiling => compiling).should == []
+        $x = 0
+        {
+          $x = $x + 1
+        }
+        repeat 2 {
+          {
+            $x = $x + 1
+          }
+        }
+        assert $x == 3
+      EOS
+    end
   end
 
   it "should error on unbalanced scopes"
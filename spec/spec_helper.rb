@@ -51,6 +51,7 @@ class Interpreter
   def errors?;    @interpreter.encounteredErrors; end
   def errors;     @interpreter.getErrorStrings; end
   def state;      [:uninitialized, :initialized, :parsing, :executing, :finished, :aborted][@interpreter.state]; end
+  def cached?;    @interpreter.isCached; end
   def inspect;    "#<Interpreter pid:#{@pid}>"; end
 
   def run(code)
@@ -61,6 +62,31 @@ class Interpreter
     self  # return self for easy method stacking
   end
 
+  # the interpreter compiles to bytecode by default when it is started with
+  # KTURTLE_ARGS=--compile, see the Rakefile
+  def compiling?; ENV['KTURTLE_ARGS'].to_s.split.any? { |arg| ['-c', '--compile'].include? arg }; end
+
+  # runs the block with the passes that follow parsing switched as given, like
+  # with(:optimizing => false) { ... }, and switches them back to the defaults
+  def with(passes)
+    connect unless @pid
+    @interpreter.setCompiling  passes.fetch(:compiling, compiling?)
+    @interpreter.setOptimizing passes.fetch(:optimizing, true)
+    @interpreter.setInlining   passes.fetch(:inlining, false)
+    @interpreter.setMemoizing  passes.fetch(:memoizing, true)
+    yield
+  ensure
+    @interpreter.setCompiling  compiling?
+    @interpreter.setOptimizing true
+    @interpreter.setInlining   false
+    @interpreter.setMemoizing  true
+  end
+
+  # @returns the errors of running the code, with the passes switched as given
+  def errors_of(code, passes = {})
+    with(passes) { run(code); errors }
+  end
+
   def should_run_clean(code)
     run(code)
     errors?.should == false
@@ -0,0 +1,48 @@
+#  Copyright (C) 2026 by agent
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public
+#  License as published by the Free Software Foundation; either
+#  version 2 of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public
+#  License along with this program; if not, write to the Free
+#  Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+#  Boston, MA 02110-1301, USA.
+
+require File.dirname(__FILE__) + '/spec_helper.rb'
+$i = Interpreter.instance
+
+describe "arithmetic specialized on numbers" do
+
+  it "should give the same results specialized and not specialized" do
+    code = <<-EOS
+      $x = 1
+      for $i = 1 to 10 {
+        $x = $x * 2 - $i
+      }
+      assert $x == -1012
+      $y = $x / 4 + 0.5
+      assert $y < -252 and $y > -253
+      assert $x ^ 2 == 1024144
+    EOS
+    $i.errors_of(code, :optimizing => false).should == []
+    $i.errors_of(code).should == []
+  end
+
+  it "should still check the operands that are not proven numbers" do
+    [ "$x = \"kturtle\"\n$y = $x * 2",
+      "$x = true\n$y = $x - 1",
+      "$x = 0\n$y = 1 / $x"
+    ].each do |code|
+      errors = $i.errors_of(code)
+      errors.should_not be_empty
+      errors.should == $i.errors_of(code, :optimizing => false)
+    end
+  end
+end
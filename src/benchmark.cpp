@@ -0,0 +1,212 @@
+/*
+	Copyright (C) 2026 agent <agent AT local>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public
+	License as published by the Free Software Foundation; either
+	version 2 of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to the Free
+	Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+	Boston, MA 02110-1301, USA.
+*/
+
+
+// benchmarks for the developers, not built by default (see BUILD_BENCHMARKS in CMakeLists.txt)
+
+#include <iostream>
+
+#include <QApplication>
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+
+#include <KLocalizedString>
+
+#include "editor.h"
+#include "interpreter/executer.h"
+#include "interpreter/tokenizer.h"
+#include "interpreter/translator.h"
+
+
+// measures the tokenizer throughput on the scripts, repeated up to the given size
+static int tokenizerBenchmark(const QStringList& fileNames, int megabytes)
+{
+	QString script;
+	foreach (const QString &fileName, fileNames) {
+		QFile inputFile(fileName);
+		if (!inputFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+			std::cout << "Could not open file: " << qPrintable(fileName) << std::endl;
+			std::cout << "Exiting..." << std::endl;
+			return 1;
+		}
+		QTextStream in(&inputFile);
+		if (in.readLine() != KTURTLE_MAGIC_1_0) {
+			std::cout << "Skipping " << qPrintable(fileName) << ", it is not a valid KTurtle script." << std::endl;
+			continue;
+		}
+		script += Translator::instance()->localizeScript(in.readAll()) + '\n';
+	}
+	if (script.isEmpty()) {
+		std::cout << "No scripts to tokenize, give some (like scripts/*.turtle) as arguments." << std::endl;
+		return 1;
+	}
+
+	// scale the scripts up to the requested size
+	const int size = qMax(1, megabytes) * 1024 * 1024;
+	QString input;
+	input.reserve(size + script.size());
+	while (input.size() < size) input += script;
+	const double inputMegabytes = input.toUtf8().size() / (1024.0 * 1024.0);
+
+	Tokenizer tokenizer;
+	QElapsedTimer timer;
+
+	tokenizer.initialize(input);
+	TokenView view;
+	int count = 0;
+	timer.start();
+	while (tokenizer.scan(view)) count++;
+	const qint64 scanTime = qMax<qint64>(1, timer.elapsed());
+
+	tokenizer.initialize(input);
+	Token* t;
+	timer.start();
+	while ((t = tokenizer.getToken())->type() != Token::EndOfInput) delete t;
+	delete t;
+	const qint64 getTokenTime = qMax<qint64>(1, timer.elapsed());
+
+	std::cout << count << " tokens in " << inputMegabytes << " MB" << std::endl;
+	std::cout << "scan():     " << scanTime << " ms, " << inputMegabytes * 1000 / scanTime << " MB/s" << std::endl;
+	std::cout << "getToken(): " << getTokenTime << " ms, " << inputMegabytes * 1000 / getTokenTime << " MB/s" << std::endl;
+	return 0;
+}
+
+// measures copying, arithmetic and comparison of values, and prints the memory used per node and per variable
+static int valueBenchmark(int millions)
+{
+	const int count = qMax(1, millions) * 1000000;
+	std::cout << "Value:        " << sizeof(Value) << " bytes" << std::endl;
+	std::cout << "TreeNode:     " << sizeof(TreeNode) << " bytes, its value included" << std::endl;
+	std::cout << "VariableSlot: " << sizeof(VariableSlot) << " bytes per variable" << std::endl;
+
+	// a mix like on the value stack of the executer, mostly numbers
+	QVector<Value> values;
+	values << Value(1.5) << Value(true) << Value(42.0) << Value(QString("turtle"));
+	QElapsedTimer timer;
+	double sink = 0;  // keeps the compiler from optimizing the loops away
+
+	Value copy;
+	timer.start();
+	for (int i = 0; i < count; i++) {
+		copy = values.at(i & 3);
+		sink += copy.type();
+	}
+	const double copyTime = timer.nsecsElapsed() / static_cast<double>(count);
+
+	Value sum(0.0), step(0.5);
+	timer.start();
+	for (int i = 0; i < count; i++) {
+		Value term(values.at(i & 1 ? 0 : 2));
+		sum + &term;
+		sum - &step;
+		sum * &step;
+	}
+	sink += sum.number();
+	const double arithmeticTime = timer.nsecsElapsed() / static_cast<double>(count);
+
+	timer.start();
+	for (int i = 0; i < count; i++) {
+		Value& value = values[i & 3];
+		if (value == &values[2]) sink++;
+		if (value < &values[0]) sink++;
+		if (value >= &values[3]) sink++;
+	}
+	const double comparisonTime = timer.nsecsElapsed() / static_cast<double>(count);
+
+	std::cout << "copy:         " << copyTime << " ns" << std::endl;
+	std::cout << "arithmetic:   " << arithmeticTime << " ns (a copy, +, - and *)" << std::endl;
+	std::cout << "comparison:   " << comparisonTime << " ns (==, < and >=)" << std::endl;
+	std::cout << "checksum:     " << sink << std::endl;
+	return 0;
+}
+
+// measures the time the editor takes per keystroke and per cursor move in a large document
+static int editorBenchmark(QApplication& app, int thousands)
+{
+	const int lineCount = qMax(1, thousands) * 1000;
+	const QString lines[] = { "reset", "repeat 4 {", "  forward 100", "  turnleft 90", "}", "$x = $x + 1  # count", "print \"done\"", "" };
+	const int lineKinds = sizeof(lines) / sizeof(lines[0]);
+	QString text;
+	for (int i = 0; i < lineCount; i++)
+		text += lines[i % lineKinds] + '\n';
+
+	Editor editor;  // not shown, the highlighter runs all the same
+	QElapsedTimer timer;
+	timer.start();
+	editor.openExample(text, "benchmark");  // large documents are highlighted lazily, as with opening a file
+	app.processEvents();
+	const qint64 loadTime = timer.elapsed();
+
+	// type and move in the middle of the document, like a user would
+	const int keystrokes = 1000;
+	QTextEdit* view = editor.view();
+	view->setTextCursor(QTextCursor(editor.document()->findBlockByNumber(lineCount / 2)));
+	qint64 typeTime = 0, typeMax = 0;
+	for (int i = 0; i < keystrokes; i++) {
+		timer.start();
+		view->insertPlainText(i % 16 == 15 ? "\n" : "x");
+		app.processEvents();  // the changed blocks of a large document are highlighted after the keystroke
+		const qint64 time = timer.nsecsElapsed();
+		typeTime += time;
+		typeMax = qMax(typeMax, time);
+	}
+	qint64 moveTime = 0, moveMax = 0;
+	for (int i = 0; i < keystrokes; i++) {
+		timer.start();
+		view->moveCursor(i % 2 ? QTextCursor::Up : QTextCursor::Down);
+		const qint64 time = timer.nsecsElapsed();
+		moveTime += time;
+		moveMax = qMax(moveMax, time);
+	}
+
+	std::cout << editor.document()->blockCount() << " lines, loaded in " << loadTime << " ms" << std::endl;
+	std::cout << "keystroke:   " << typeTime / keystrokes / 1000 << " us on average, " << typeMax / 1000 << " us at most" << std::endl;
+	std::cout << "cursor move: " << moveTime / keystrokes / 1000 << " us on average, " << moveMax / 1000 << " us at most" << std::endl;
+	return 0;
+}
+
+
+int main(int argc, char* argv[])
+{
+	KLocalizedString::setApplicationDomain("kturtle");
+	QApplication app(argc, argv);
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Benchmarks for KTurtle developers");
+	parser.addHelpOption();
+	parser.addOption(QCommandLineOption(QStringList() << "k" << "tokenize", "Measures the tokenizer throughput on the script files given as arguments, repeated up to the given size", "megabytes"));
+	parser.addOption(QCommandLineOption(QStringList() << "value", "Measures copying, arithmetic and comparison of values the given amount of million times, and prints the memory used per node and per variable", "millions"));
+	parser.addOption(QCommandLineOption(QStringList() << "editor", "Measures the time the editor takes per keystroke and per cursor move in a document of the given amount of thousand lines", "thousands"));
+	parser.addPositionalArgument("scripts", "The scripts to tokenize", "[scripts...]");
+	parser.process(app);
+
+	Translator::instance()->setLanguage();
+
+	if (parser.isSet("tokenize"))
+		return tokenizerBenchmark(parser.positionalArguments(), parser.value("tokenize").toInt());
+	if (parser.isSet("value"))
+		return valueBenchmark(parser.value("value").toInt());
+	if (parser.isSet("editor"))
+		return editorBenchmark(app, parser.value("editor").toInt());
+
+	parser.showHelp(1);
+}
@@ -22,6 +22,7 @@
 #include <cmath>
 
 #include <QResizeEvent>
+#include <QStyleOptionGraphicsItem>
 #include <QWheelEvent>
 #include <QtMath>
 
@@ -31,7 +32,9 @@
 
 int kTurtleZValue = 1;
 int kCanvasFrameZValue = -10000;
+int kRasterZValue = -5000;  // above the canvas frame
 int kCanvasMargin = 20;
+int kMaxLineBatchSize = 1024;  // segments per LineBatch, so the scene index still helps when repainting
 
 
 Canvas::Canvas(QWidget *parent) : QGraphicsView(parent)
@@ -49,6 +52,8 @@ Canvas::Canvas(QWidget *parent) : QGraphicsView(parent)
 
 	// foreground pen for drawing
 	pen = new QPen();
+	lineBatch = nullptr;
+	raster = nullptr;
 	
 	// font
 	textFont = new QFont();
@@ -76,6 +81,7 @@ Canvas::~Canvas()
 	delete pen;
 	delete turtle;
 	delete canvasFrame;
+	delete raster;
 	delete textFont;
 	delete _scene;
 }
@@ -86,6 +92,7 @@ void Canvas::initValues()
 	_scene->setSceneRect(QRectF(0, 0, 400, 400));
 	canvasFrame->setBrush(QBrush());
 	canvasFrame->setRect(_scene->sceneRect());
+	if (raster) raster->setRect(_scene->sceneRect());
 	fitInView(_scene->sceneRect().adjusted(kCanvasMargin * -1, kCanvasMargin * -1, kCanvasMargin, kCanvasMargin), Qt::KeepAspectRatio);
 	turtle->setPos(200, 200);
 	turtle->setAngle(0);
@@ -117,11 +124,17 @@ QColor Canvas::rgbDoublesToColor(double r, double g, double b)
 
 void Canvas::drawLine(double x1, double y1, double x2, double y2)
 {
-	if (penWidthIsZero) return;
-	QGraphicsLineItem* line = new QGraphicsLineItem(QLineF(x1, y1, x2, y2), nullptr);
-	_scene->addItem(line);
-	line->setPen(*pen);
-	lines.append(line);
+	if (penWidthIsZero || pen->style() == Qt::NoPen) return;
+	if (raster) {
+		raster->drawLine(QLineF(x1, y1, x2, y2), *pen);
+		return;
+	}
+	// start a new batch when the pen changed
+	if (lineBatch == nullptr || lineBatch->pen() != *pen || lineBatch->segmentCount() >= kMaxLineBatchSize) {
+		lineBatch = new LineBatch(*pen);
+		_scene->addItem(lineBatch);
+	}
+	lineBatch->appendLine(QLineF(x1, y1, x2, y2));
 }
 
 
@@ -130,9 +143,34 @@ void Canvas::slotClear()
 	QList<QGraphicsItem*> list = _scene->items();
 	foreach (QGraphicsItem* item, list) {
 		// delete all but the turtle (who lives on a separate layer with z-value 1)
-		if ((item->zValue() != kTurtleZValue) && (item->zValue() != kCanvasFrameZValue))
+		if ((item->zValue() != kTurtleZValue) && (item->zValue() != kCanvasFrameZValue) && (item != raster))
 			delete item;
 	}
+	lineBatch = nullptr;
+	if (raster) raster->clear();
+}
+
+void Canvas::setRasterMode(bool enabled)
+{
+	if (enabled == rasterMode()) return;
+	if (enabled) {
+		raster = new RasterLayer(_scene->sceneRect());
+		raster->setZValue(kRasterZValue);
+		_scene->addItem(raster);
+		// the drawing so far is painted on the raster from the bottom up, so it keeps its stacking order
+		foreach (QGraphicsItem* item, _scene->items(Qt::AscendingOrder)) {
+			if ((item->zValue() != kTurtleZValue) && (item->zValue() != kCanvasFrameZValue) && (item != raster)) {
+				raster->drawItem(item);
+				delete item;
+			}
+		}
+		lineBatch = nullptr;
+	} else {
+		// the raster cannot be turned back into lines, so the drawing is cleared
+		delete raster;
+		raster = nullptr;
+		slotClear();
+	}
 }
 
 void Canvas::slotForward(double x)
@@ -187,18 +225,25 @@ void Canvas::slotCanvasSize(double r, double g)
 {
 	_scene->setSceneRect(QRectF(0,0,r,g));
 	canvasFrame->setRect(_scene->sceneRect());
+	if (raster) raster->setRect(_scene->sceneRect());
 	fitInView(_scene->sceneRect(), Qt::KeepAspectRatio);
 }
 
 void Canvas::slotPrint(const QString& text)
 {
     QGraphicsTextItem *ti = new QGraphicsTextItem(text, nullptr);
-	_scene->addItem(ti);
 // 	ti->setDefaultTextColor(textColor);
 	ti->setFont(*textFont);
 	ti->setTransform(QTransform().rotate(turtle->angle()), true);
 	ti->setPos(turtle->pos().x(), turtle->pos().y());
 	ti->setDefaultTextColor(textColor);
+	if (raster) {
+		raster->drawItem(ti);
+		delete ti;
+		return;
+	}
+	_scene->addItem(ti);
+	lineBatch = nullptr;  // lines drawn after the text have to end up above it
 }
 
 void Canvas::slotFontType(const QString& family, const QString& extra)
@@ -246,6 +291,25 @@ void Canvas::getDirection(double &value)
 
 QImage Canvas::getPicture()
 {
+	if (raster) {
+		// the drawing already is a raster, it only has to be put on the canvas color
+		QImage picture(sceneRect().size().toSize(), QImage::Format_RGB32);
+		const QBrush brush = canvasFrame->brush();
+		picture.fill(brush.style() == Qt::NoBrush ? QColor(Qt::white) : brush.color());
+		QPainter p(&picture);
+		p.translate(-sceneRect().topLeft());
+		raster->paintTiles(&p, sceneRect());
+		if (turtle->isVisible()) {
+			// on top of the drawing, as the scene renders it in vector mode
+			QStyleOptionGraphicsItem option;
+			p.setRenderHint(QPainter::Antialiasing);
+			p.setTransform(turtle->sceneTransform(), true);
+			turtle->paint(&p, &option);
+		}
+		p.end();
+		return picture;
+	}
+
 	QImage png(sceneRect().size().toSize(), QImage::Format_RGB32);
 	// create a painter to draw on the image
 	QPainter p(&png);
@@ -255,7 +319,7 @@ QImage Canvas::getPicture()
 	return png;
 }
 
-void Canvas::saveAsSvg(const QString& title, const QString& fileName)
+bool Canvas::saveAsSvg(const QString& title, const QString& fileName)
 {
 	Q_UNUSED(title);
 	// it would have been nicer if this method didn't needed to be passed a filename..
@@ -268,6 +332,7 @@ void Canvas::saveAsSvg(const QString& title, const QString& fileName)
 //	generator.setDescription(i18n("Created with KTurtle %1 -- %2").arg(version).arg(website));
 	// create a painter to draw on the image
 	QPainter p(&generator);
+	if (!p.isActive()) return false;  // the file could not be opened
 // 	p.setRenderHint(QPainter::Antialiasing);  // antialiasing like our Canvas
 
 	bool spriteWasVisible = turtle->isVisible();
@@ -277,5 +342,5 @@ void Canvas::saveAsSvg(const QString& title, const QString& fileName)
 
 	if(spriteWasVisible)
 		slotSpriteShow();
-	p.end();
+	return p.end();
 }
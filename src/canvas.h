@@ -23,6 +23,8 @@
 #include <QGraphicsView>
 #include <QSvgGenerator>
 
+#include "linebatch.h"
+#include "rasterlayer.h"
 #include "sprite.h"
 
 
@@ -36,7 +38,11 @@ class Canvas : public QGraphicsView
 
 		double turtleAngle() { return turtle->angle(); }
 		QImage getPicture();
-		void saveAsSvg(const QString&, const QString&);
+		bool saveAsSvg(const QString&, const QString&);  // FALSE when the file could not be written
+
+		/// In raster mode lines and text are painted on a RasterLayer instead of being scene items
+		bool rasterMode() const { return raster != nullptr; }
+		void setRasterMode(bool enabled);
 // 		void scene() { return _scene; }
 
 	public slots:
@@ -79,8 +85,8 @@ class Canvas : public QGraphicsView
 		QGraphicsScene            *_scene;
 		QPen                      *pen;
 		Sprite                    *turtle;
-		QList<QGraphicsLineItem*>  lines;
-		QGraphicsLineItem         *line;
+		LineBatch                 *lineBatch;  // new line segments go here, zero when a new batch is needed
+		RasterLayer               *raster;     // zero unless in raster mode
 		QGraphicsRectItem         *canvasFrame;
 		bool                       penWidthIsZero;
 		QFont                      *textFont;
@@ -28,6 +28,7 @@
 #include <QSaveFile>
 #include <QTemporaryFile>
 #include <QTextStream>
+#include <QThread>
 #include <QBuffer>
 
 #include <KFind>
@@ -38,6 +39,35 @@
 
 static const int CURSOR_WIDTH = 2;  // in pixels
 static const int TAB_WIDTH    = 2;  // in character widths
+static const int LARGE_DOCUMENT_SIZE = 1024 * 1024;  // in characters (or bytes of a file), larger ones are highlighted lazily
+
+
+/// The worker thread that loads the large files of Editor::openFile()
+class LoadThread : public QThread
+{
+	public:
+		explicit LoadThread(Editor* editor) : QThread(editor), editor(editor) {}
+
+	protected:
+		void run() override { editor->loadInBackground(); }
+
+	private:
+		Editor* editor;
+};
+
+/// Checks the magic identifier of the file @p data and puts its localized code in @p script, @returns FALSE for no valid script
+static bool readScript(QByteArray& data, QString& script)
+{
+	QBuffer buffer(&data);
+	if (!buffer.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		return false; // can't happen
+	}
+	QTextStream in(&buffer);
+	// check for our magic identifier
+	if (in.readLine() != KTURTLE_MAGIC_1_0) return false;
+	script = Translator::instance()->localizeScript(in.readAll());
+	return true;
+}
 
 
 Editor::Editor(QWidget *parent)
@@ -48,6 +78,10 @@ Editor::Editor(QWidget *parent)
 	setCurrentUrl();
 	currentRow = 1;
 	currentCol = 1;
+	lineCount  = 1;
+	largeDocument = false;
+	highlightingBlocks = false;
+	loadingFailed = false;
 
 	// setup the main view
 	editor = new TextEdit(this);
@@ -68,6 +102,8 @@ Editor::Editor(QWidget *parent)
 	numbers->setWidth(1);
 	connect(editor->document()->documentLayout(), SIGNAL(update(QRectF)), numbers, SLOT(update()));
 	connect(editor->verticalScrollBar(), SIGNAL(valueChanged(int)), numbers, SLOT(update()));
+	connect(editor->verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(viewChanged()));
+	connect(editor->document()->documentLayout(), SIGNAL(update(QRectF)), this, SLOT(viewChanged()));
 
 	// let the line numbers and the editor coexist
 	box = new QHBoxLayout(this);
@@ -85,6 +121,11 @@ Editor::Editor(QWidget *parent)
 
 	// our syntax highlighter (this does not do any markings)
 	highlighter = new Highlighter(editor->document());
+	highlightTimer.setSingleShot(true);
+	connect(&highlightTimer, &QTimer::timeout, this, &Editor::highlightVisibleBlocks);
+
+	loadThread = new LoadThread(this);
+	connect(loadThread, &QThread::finished, this, &Editor::loadedInBackground);
 
 	// create a find dialog
 	fdialog = new KFindDialog();
@@ -94,13 +135,12 @@ Editor::Editor(QWidget *parent)
 
 	// sets some more default values
 	newFile();
-	tokenizer = new Tokenizer();
 }
 
 Editor::~Editor()
 {
+	loadThread->wait();
 	delete highlighter;
-	delete tokenizer;
 }
 
 void Editor::enable() {
@@ -117,8 +157,14 @@ void Editor::disable() {
 
 void Editor::setContent(const QString& s)
 {
+	// the highlighter is detached from large documents, so it does not highlight all the blocks at once
+	bool large = s.length() > LARGE_DOCUMENT_SIZE;
+	if (large && !largeDocument) highlighter->setDocument(nullptr);
 	editor->document()->setPlainText(s);
+	if (!large && largeDocument) highlighter->setDocument(editor->document());
+	largeDocument = large;
 	editor->document()->setModified(false);
+	if (largeDocument) highlightTimer.start();
 }
 
 void Editor::openExample(const QString& example, const QString& exampleName)
@@ -132,12 +178,24 @@ void Editor::openExample(const QString& example, const QString& exampleName)
 
 void Editor::textChanged(int pos, int removed, int added)
 {
-	Q_UNUSED(pos);
+	if (highlightingBlocks) return;  // only the formats changed
 	if (removed == 0 && added == 0) return;  // save some cpu cycles
+	if (largeDocument) highlightTimer.start();
 	removeMarkings();  // removes the character markings if there are any
-	int lineCount = 1;
-	for (QTextBlock block = editor->document()->begin(); block.isValid(); block = block.next()) lineCount++;
-	numbers->setWidth(qMax(1, 1 + static_cast<int>(std::floor(std::log10(static_cast<double>(lineCount) - 1)))));
+	QTextDocument* doc = editor->document();
+	int blockCount = doc->blockCount();
+	if (blockCount != lineCount)
+		numbers->setWidth(qMax(1, 1 + static_cast<int>(std::floor(std::log10(static_cast<double>(blockCount))))));
+
+	// only pass on the lines that changed, the text of the other ones is not copied
+	QTextBlock block = doc->findBlock(pos);
+	int firstLine = block.blockNumber();
+	int lastLine = doc->findBlock(qMin(pos + added, doc->characterCount() - 1)).blockNumber();
+	QStringList addedLines;
+	for (int line = firstLine; line <= lastLine; line++, block = block.next())
+		addedLines << block.text();
+	emit linesChanged(firstLine, lastLine - firstLine + 1 - (blockCount - lineCount), addedLines);
+	lineCount = blockCount;
 
 	emit contentChanged();
 }
@@ -146,7 +204,7 @@ void Editor::textChanged(int pos, int removed, int added)
 bool Editor::newFile()
 {
 	if (maybeSave()) {
-		editor->document()->clear();
+		setContent(QString());
 		setCurrentUrl();
 		return true;
 	}
@@ -156,6 +214,7 @@ bool Editor::newFile()
 bool Editor::openFile(const QUrl &_url)
 {
 	QUrl url = _url;
+	if (loadThread->isRunning()) return false;  // still loading a large file
 	if (maybeSave()) {
 		if (url.isEmpty()) {
             url = QFileDialog::getOpenFileUrl(this, 
@@ -168,19 +227,19 @@ bool Editor::openFile(const QUrl &_url)
 			KIO::StoredTransferJob *job = KIO::storedGet(url);
 			if (job->exec()) {
 				QByteArray data = job->data();
-				QBuffer buffer(&data);
-				if (!buffer.open(QIODevice::ReadOnly | QIODevice::Text)) {
-					return false; // can't happen
+				if (data.size() > LARGE_DOCUMENT_SIZE) {
+					// keep the GUI responsive while decoding and localizing, continues in loadedInBackground()
+					loadingUrl = url;
+					loadingData = data;
+					disable();
+					loadThread->start();
+					return true;
 				}
-				QTextStream in(&buffer);
-				// check for our magic identifier
-				QString s;
-				s = in.readLine();
-				if (s != KTURTLE_MAGIC_1_0) {
+				QString localizedScript;
+				if (!readScript(data, localizedScript)) {
 					KMessageBox::error(this, i18n("The file you try to open is not a valid KTurtle script, or is incompatible with this version of KTurtle.\nCannot open %1", url.toDisplayString(QUrl::PreferLocalFile)));
 					return false;
 				}
-				QString localizedScript = Translator::instance()->localizeScript(in.readAll());
 				setContent(localizedScript);
 				setCurrentUrl(url);
 				editor->document()->setModified(false);
@@ -196,6 +255,31 @@ bool Editor::openFile(const QUrl &_url)
 	return false;
 }
 
+void Editor::loadInBackground()
+{
+	loadingFailed = !readScript(loadingData, loadedScript);
+	loadingData.clear();
+}
+
+void Editor::loadedInBackground()
+{
+	enable();
+	if (loadingFailed) {
+		KMessageBox::error(this, i18n("The file you try to open is not a valid KTurtle script, or is incompatible with this version of KTurtle.\nCannot open %1", loadingUrl.toDisplayString(QUrl::PreferLocalFile)));
+		return;
+	}
+	setContent(loadedScript);
+	loadedScript.clear();
+	setCurrentUrl(loadingUrl);
+	editor->document()->setModified(false);
+	emit fileOpened(loadingUrl);
+}
+
+void Editor::waitForLoading()
+{
+	loadThread->wait();
+}
+
 bool Editor::saveFile(const QUrl &targetUrl)
 {
 	QUrl url(targetUrl);
@@ -348,45 +432,22 @@ void Editor::setOverwriteMode(bool b)
 
 void Editor::updateOnCursorPositionChange()
 {
-	// convert the absolute pos into a row/col pair, and set current line aswell
-	QString s = editor->toPlainText();
-	int pos = editor->textCursor().position();
-	int row = 1;
-	int last_break = -1;
-	int next_break = 0;
-	for (int i = 0; i < s.length(); i++) {
-		if (s.at(i) == '\n' && i < pos) {
-			last_break = i;
-			row++;
-		} else if (s.at(i) == '\n' && i >= pos) {
-			next_break = i;
-			break;
-		}
-	}
-	if (next_break == 0)
-		next_break = s.length();
+	// the block of the cursor is its line, no need to look at the rest of the text
+	QTextCursor cursor = editor->textCursor();
+	int row = cursor.blockNumber() + 1;
 	if (currentRow != row) {
 		currentRow = row;
 		highlightCurrentLine();
 		editor->highlightCurrentLine();
 	}
-	currentCol = pos - last_break;
-	currentLine = s.mid(last_break+1, next_break-last_break-1);
+	currentCol = cursor.positionInBlock() + 1;
 	emit cursorPositionChanged();
 }
 
 Token* Editor::currentToken()
 {
-	tokenizer->initialize(currentLine);
-	Token* token = tokenizer->getToken();
-	while (token->type() != Token::EndOfInput) {
-		if (currentCol >= token->startCol() && currentCol <= token->endCol())
-			return token;
-		delete token;
-		token = tokenizer->getToken();
-	}
-	delete token;
-	return nullptr;
+	// the highlighter keeps the tokens of every line
+	return highlighter->tokenAt(editor->textCursor().block(), currentCol);
 }
 
 
@@ -396,9 +457,39 @@ void Editor::insertPlainText(const QString& txt)
 }
 
 
+void Editor::highlightCurrentLine()
+{
+	currentLineRect = editor->currentLineRect();
+	update();
+}
+
+void Editor::viewChanged()
+{
+	highlightCurrentLine();
+	if (largeDocument) highlightTimer.start();
+}
+
+void Editor::highlightVisibleBlocks()
+{
+	QTextBlock block = editor->cursorForPosition(QPoint(0, 0)).block();
+	QTextBlock end = editor->cursorForPosition(QPoint(0, editor->viewport()->height())).block().next();
+	highlightingBlocks = true;
+	for (; block.isValid() && block != end; block = block.next())
+		highlighter->highlightDetached(block);
+	highlightingBlocks = false;
+}
+
+void Editor::rehighlight()
+{
+	if (largeDocument)
+		highlightVisibleBlocks();  // the others are highlighted again when they become visible
+	else
+		highlighter->rehighlight();
+}
+
 void Editor::paintEvent(QPaintEvent *event)
 {
-	QRect rect = editor->currentLineRect();
+	QRect rect = currentLineRect;
 	rect.setWidth(this->width() - EDITOR_MARGIN);  // don't draw too much
 	rect.translate(0, EDITOR_MARGIN);  // small hack to nicely align the line highlighting
 	//QColor bgColor = this->palette().brush(this->backgroundRole()).color();
@@ -27,6 +27,7 @@
 #include <QPainter>
 #include <QScrollBar>
 #include <QTextEdit>
+#include <QTimer>
 
 #include <KFindDialog>
 
@@ -36,6 +37,7 @@
 #include "interpreter/treenode.h"
 
 class QHBoxLayout;
+class LoadThread;
 
 
 static const QColor LINE_HIGHLIGHT_COLOR(239, 247, 255);
@@ -76,9 +78,11 @@ class LineNumbers : public QWidget
 			qreal pageBottom = contentsY + editor->viewport()->height();
 			const QFontMetrics fm = fontMetrics();
 			const int ascent = fontMetrics().ascent() + 1;  // height = ascent + descent + 1
-			int lineCount = 1;
+			// start at the first visible block, instead of walking past all the blocks above it
+			QTextBlock block = editor->cursorForPosition(QPoint(0, 0)).block();
+			int lineCount = block.blockNumber() + 1;
 			QPainter painter(this);
-			for (QTextBlock block = editor->document()->begin(); block.isValid(); block = block.next(), ++lineCount) {
+			for (; block.isValid(); block = block.next(), ++lineCount) {
 				const QRectF boundingRect = layout->blockBoundingRect(block);
 				QPointF position = boundingRect.topLeft();
 				if (position.y() + boundingRect.height() < contentsY) continue;
@@ -252,7 +256,9 @@ class Editor : public QFrame
 		void findNext();
 		void findPrev();
 		void insertPlainText(const QString& txt);
-		void rehighlight() { highlighter->rehighlight(); }
+		void rehighlight();
+		/// Waits until a large file is loaded in the background, it uses the dictionary of the Translator
+		void waitForLoading();
 
 
 	signals:
@@ -261,6 +267,8 @@ class Editor : public QFrame
 		void fileSaved(const QUrl&);
 		void modificationChanged();
 		void contentChanged();
+		/// Emitted with every change of the text, @p removedLines lines from @p firstLine (counted from zero) are replaced by @p addedLines
+		void linesChanged(int firstLine, int removedLines, const QStringList& addedLines);
 		void cursorPositionChanged();
 
 
@@ -274,22 +282,37 @@ class Editor : public QFrame
 
 	private slots:
 		void updateOnCursorPositionChange();
-		void highlightCurrentLine() { this->update(); }
+		void highlightCurrentLine();
+		void viewChanged();
+		void highlightVisibleBlocks();
+		void loadedInBackground();
 
 	private:
+		friend class LoadThread;
+
 		void setContent(const QString&);
+		/// Decodes and localizes the file that is loaded, run by the worker thread
+		void loadInBackground();
 
 		TextEdit    *editor;  // TODO why pointers?
 		Highlighter *highlighter;  // TODO could this class become a singleton? (shared with the inspector, errdlg)
-		Tokenizer   *tokenizer;  // TODO could this class become a singleton? (shared with the highlighter, interpreter)
 		LineNumbers *numbers;
 		QHBoxLayout *box;  // TODO is this relly needed?
 		KFindDialog *fdialog;
 		QUrl         m_currentUrl;  // contains url to the currently load file or the exampleName
 		QColor       highlightedLineBackgroundColor;  // the bg color of the current line's line number space
-		QString      currentLine;
+		QRect        currentLineRect;  // the line number space to highlight, kept out of paintEvent()
+		bool         largeDocument;  // when TRUE the highlighter is detached, only the visible blocks are highlighted
+		bool         highlightingBlocks;  // TRUE while the formats of the visible blocks are changed
+		QTimer       highlightTimer;  // highlights the visible blocks of a large document after scrolling or editing
+		LoadThread  *loadThread;
+		QUrl         loadingUrl;  // the large file that is loaded in the background
+		QByteArray   loadingData;
+		QString      loadedScript;
+		bool         loadingFailed;
 		int          currentRow;
 		int          currentCol;
+		int          lineCount;  // the amount of lines before the last change
 };
 
 
@@ -19,6 +19,9 @@
 
 #include "highlighter.h"
 
+#include <QTextDocument>
+#include <QTextLayout>
+
 #include "interpreter/tokenizer.h"
 
 
@@ -60,6 +63,7 @@ Highlighter::Highlighter(QTextDocument *parent)
 	assignmentFormat.setForeground(Qt::black);
 
 	tokenizer = new Tokenizer();
+	statementTypesVersion = -1;
 }
 
 Highlighter::~Highlighter()
@@ -70,34 +74,105 @@ Highlighter::~Highlighter()
 
 QTextCharFormat* Highlighter::formatForStatement(const QString &text)
 {
-	// TODO store the Token (pointer) in the respective inspector lists so we don't have to re-tokenize here...
-	tokenizer->initialize(text);
-	return tokenToFormat(tokenizer->getToken());
+	// the Inspector asks for the same few variable names over and over again
+	if (statementTypesVersion != Translator::instance()->dictionaryVersion()) {
+		statementTypes.clear();
+		statementTypesVersion = Translator::instance()->dictionaryVersion();
+	}
+	QHash<QString, int>::const_iterator type = statementTypes.constFind(text);
+	if (type == statementTypes.constEnd()) {
+		tokenizer->initialize(text);
+		TokenView view;
+		tokenizer->scan(view);
+		type = statementTypes.insert(text, view.type);
+	}
+	return typeToFormat(type.value());
 }
 
-Token* Highlighter::checkOrApplyHighlighting(const QString& text, int cursorIndex)
+Token* Highlighter::tokenAt(QTextBlock block, int col)
 {
-	tokenizer->initialize(text);
-	Token* token = tokenizer->getToken();
-	QTextCharFormat* format;
-	while (token->type() != Token::EndOfInput) {
-		format = tokenToFormat(token);
-		if (format) {
-			if (cursorIndex == -1)  // does not return, but keeps running
-				setFormat(token->startCol() - 1, token->endCol() - token->startCol(), *format);
-			else if (cursorIndex >= token->startCol() && cursorIndex <= token->endCol())
-				return token;  // returns, one shot only
+	const QString text = block.text();
+	BlockTokens* data = blockTokens(block, text);
+	foreach (const BlockToken& token, data->tokens) {
+		if (!typeToFormat(token.type)) continue;  // like white space, not something to show help on
+		if (col >= token.start + 1 && col <= token.start + token.length + 1) {
+			TokenView view;
+			view.type     = token.type;
+			view.start    = token.start;
+			view.length   = token.length;
+			view.startRow = view.endRow = 1;
+			view.startCol = token.start + 1;
+			view.endCol   = token.start + token.length + 1;
+			tokenizer->initialize(text);  // for the look, the text is not tokenized again
+			return tokenizer->toToken(view);
 		}
-		delete token;
-		token = tokenizer->getToken();
 	}
-	delete token;
 	return nullptr;
 }
 
+void Highlighter::highlightBlock(const QString &text)
+{
+	BlockTokens* data = blockTokens(currentBlock(), text);
+	foreach (const BlockToken& token, data->tokens) {
+		QTextCharFormat* format = typeToFormat(token.type);
+		if (format)
+			setFormat(token.start, token.length, *format);
+	}
+	data->formatted = true;
+}
+
+void Highlighter::highlightDetached(QTextBlock block)
+{
+	BlockTokens* data = blockTokens(block, block.text());
+	if (data->formatted) return;
+	// this is what QSyntaxHighlighter does for the blocks it highlights
+	QList<QTextLayout::FormatRange> ranges;
+	foreach (const BlockToken& token, data->tokens) {
+		QTextCharFormat* format = typeToFormat(token.type);
+		if (!format) continue;
+		QTextLayout::FormatRange range;
+		range.start  = token.start;
+		range.length = token.length;
+		range.format = *format;
+		ranges << range;
+	}
+	block.layout()->setAdditionalFormats(ranges);
+	block.document()->markContentsDirty(block.position(), block.length());
+	data->formatted = true;
+}
+
+BlockTokens* Highlighter::blockTokens(QTextBlock block, const QString &text)
+{
+	BlockTokens* data = static_cast<BlockTokens*>(block.userData());
+	int version = Translator::instance()->dictionaryVersion();
+	if (data && data->dictionaryVersion == version && data->revision == block.revision())
+		return data;  // every edit of the block changes its revision, undoing it gives the earlier one back
+
+	if (!data) {
+		data = new BlockTokens();
+		block.setUserData(data);  // the block owns it
+	}
+	data->revision = block.revision();
+	data->dictionaryVersion = version;
+	data->formatted = false;
+	data->tokens.resize(0);  // keeps the allocated capacity
+	tokenizer->initialize(text);
+	TokenView view;
+	while (tokenizer->scan(view)) {
+		BlockToken token = { view.type, view.start, view.length };
+		data->tokens.append(token);
+	}
+	return data;
+}
+
 QTextCharFormat* Highlighter::tokenToFormat(Token* token)
 {
-	switch (token->category()) {
+	return typeToFormat(token->type());
+}
+
+QTextCharFormat* Highlighter::typeToFormat(int type)
+{
+	switch (Token::typeToCategory(type)) {
 		case Token::VariableCategory:          return &variableFormat;
 		case Token::TrueFalseCategory:         return &trueFalseFormat;
 		case Token::NumberCategory:            return &numberFormat;
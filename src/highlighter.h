@@ -20,12 +20,43 @@
 #ifndef _HIGHLIGHTER_H_
 #define _HIGHLIGHTER_H_
 
+#include <QHash>
 #include <QSyntaxHighlighter>
+#include <QTextBlockUserData>
 #include <QTextCharFormat>
+#include <QVector>
 
 #include "interpreter/tokenizer.h"
 
 
+/**
+ * @short A token of a block, in less than half the size of a TokenView.
+ * A block is one line, so its row and columns follow from the start and the length.
+ */
+typedef struct {
+	int type;
+	int start;   // index of the first character in the text of the block
+	int length;  // number of characters
+} BlockToken;
+
+
+/**
+ * @short The tokens of one block (line) of the code, kept as its user data.
+ * The block is only tokenized again when its revision or the dictionary changed.
+ * KTurtle has no tokens that span lines, so the blocks are tokenized on their own.
+ */
+class BlockTokens : public QTextBlockUserData
+{
+	public:
+		BlockTokens() : revision(-1), dictionaryVersion(-1), formatted(false) {}
+
+		int                 revision;           // the QTextBlock::revision() the tokens are found in
+		int                 dictionaryVersion;  // see Translator::dictionaryVersion()
+		QVector<BlockToken> tokens;             // all of them but the EndOfInput
+		bool                formatted;          // TRUE when the block has the formats of these tokens
+};
+
+
 class Highlighter : public QSyntaxHighlighter
 {
 	Q_OBJECT
@@ -34,23 +65,31 @@ class Highlighter : public QSyntaxHighlighter
         explicit Highlighter(QTextDocument *parent = nullptr);
 		~Highlighter();
 
-		/// used by the Editor for highlighting
-		Token* formatType(const QString &text, int cursorIndex) { return checkOrApplyHighlighting(text, cursorIndex); }
+		/// used by the Editor, @returns a newly created Token for the token of @p block at column @p col (zero if there is none)
+		Token* tokenAt(QTextBlock block, int col);
+
+		/// used by the Editor for large documents, the highlighter is not attached to those: highlights @p block when it changed
+		void highlightDetached(QTextBlock block);
 
 		/// used by the Inspector to give the text format for a single statement (first in the text)
 		QTextCharFormat* formatForStatement(const QString &text);
 
 		/// used by internally and by the Inspector
 		QTextCharFormat* tokenToFormat(Token* token);
+		QTextCharFormat* typeToFormat(int type);
 
 	protected:
-		void highlightBlock(const QString &text) Q_DECL_OVERRIDE { checkOrApplyHighlighting(text); }
+		void highlightBlock(const QString &text) Q_DECL_OVERRIDE;
 
 	private:
-		Token* checkOrApplyHighlighting(const QString &text, int cursorIndex = -1);
+		/// @returns the tokens of @p block with the text @p text, tokenizing it when they are not cached
+		BlockTokens* blockTokens(QTextBlock block, const QString &text);
 
 		Tokenizer* tokenizer;
 
+		QHash<QString, int> statementTypes;  // the token types found by formatForStatement()
+		int statementTypesVersion;           // the dictionary version of statementTypes
+
 		QTextCharFormat variableFormat;
 		QTextCharFormat trueFalseFormat;
 		QTextCharFormat commentFormat;
@@ -27,11 +27,106 @@
 #include <QHeaderView>
 #include <QTabWidget>
 #include <QTableWidget>
-#include <QTreeWidget>
+#include <QTimer>
+#include <QTreeView>
 
 #include <KLocalizedString>
 
 
+static const int FLUSH_INTERVAL = 16;  // in milliseconds, about one frame of the display
+
+
+TreeModel::TreeModel(Highlighter* highlighter, QObject* parent)
+	: QAbstractItemModel(parent), highlighter(highlighter), root(nullptr), marked(nullptr)
+{
+	font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+	boldFont = font;
+	boldFont.setBold(true);
+}
+
+void TreeModel::setRoot(TreeNode* rootNode)
+{
+	beginResetModel();
+	root = rootNode;
+	marked = nullptr;
+	endResetModel();
+}
+
+void TreeModel::setMarked(TreeNode* node)
+{
+	if (!root) return;  // the node is not in this model
+	TreeNode* previous = marked;
+	marked = node;
+	if (previous) {
+		QModelIndex index = indexOf(previous);
+		emit dataChanged(index, index);
+	}
+	if (node) {
+		QModelIndex index = indexOf(node);
+		emit dataChanged(index, index);
+	}
+}
+
+QModelIndex TreeModel::indexOf(TreeNode* node) const
+{
+	if (!node || node == root) return QModelIndex();
+	return createIndex(node->childIndex(), 0, node);
+}
+
+QModelIndex TreeModel::index(int row, int column, const QModelIndex& parent) const
+{
+	TreeNode* parentNode = nodeAt(parent);
+	if (!parentNode || column != 0 || row < 0 || row >= static_cast<int>(parentNode->childCount()))
+		return QModelIndex();
+	return createIndex(row, 0, parentNode->child(row));
+}
+
+QModelIndex TreeModel::parent(const QModelIndex& index) const
+{
+	if (!index.isValid()) return QModelIndex();
+	return indexOf(nodeAt(index)->parent());
+}
+
+int TreeModel::rowCount(const QModelIndex& parent) const
+{
+	TreeNode* node = nodeAt(parent);
+	if (!node || parent.column() > 0) return 0;
+	return node->childCount();
+}
+
+int TreeModel::columnCount(const QModelIndex& parent) const
+{
+	Q_UNUSED(parent);
+	return 1;
+}
+
+QVariant TreeModel::data(const QModelIndex& index, int role) const
+{
+	if (!index.isValid()) return QVariant();
+	// only the rows that are shown ask for their format
+	TreeNode* node = nodeAt(index);
+	switch (role) {
+		case Qt::DisplayRole:
+			return node->token()->look();
+		case Qt::ForegroundRole: {
+			QTextCharFormat* format = highlighter->tokenToFormat(node->token());
+			if (format) return format->foreground();
+			break;
+		}
+		case Qt::FontRole: {
+			QTextCharFormat* format = highlighter->tokenToFormat(node->token());
+			if (format) return format->font().bold() ? boldFont : font;
+			break;
+		}
+		case Qt::BackgroundRole:
+			if (node == marked) return QBrush(WORD_HIGHLIGHT_COLOR);
+			break;
+	}
+	return QVariant();
+}
+
+
+
 Inspector::Inspector(QWidget *parent)
 	: QFrame(parent)
 {
@@ -56,7 +151,7 @@ Inspector::Inspector(QWidget *parent)
 
 	treeTab    = new QWidget();
 	treeLayout = new QHBoxLayout(treeTab);
-	treeView   = new QTreeWidget(treeTab);
+	treeView   = new QTreeView(treeTab);
 	treeView->header()->setVisible(false);
 	treeLayout->addWidget(treeView);
 	tabWidget->addTab(treeTab, i18n("Tree"));
@@ -65,13 +160,16 @@ Inspector::Inspector(QWidget *parent)
 
 	// our syntax highlighter (this does not do any markings)
 	highlighter = new Highlighter();
+	treeModel = new TreeModel(highlighter, this);
+	treeView->setModel(treeModel);
 
 // 	// the maps used when marking table/tree items later
 // 	variableMap = new QHash<QString, QTableWidgetItem*>();
 // 	functionMap = new QHash<QString, QTableWidgetItem*>();
-// 	treeMap = new QHash<TreeNode*, QTableWidgetItem*>();
 
-	currentlyMarkedTreeItem = nullptr;
+	flushTimer = new QTimer(this);
+	flushTimer->setSingleShot(true);
+	connect(flushTimer, &QTimer::timeout, this, &Inspector::flush);
 
 	disable();
 
@@ -96,6 +194,10 @@ void Inspector::clear()
 {
 	clearAllMarks();
 
+	flushTimer->stop();
+	pendingVariables.clear();
+	pendingFunctions.clear();
+
 	// Question: is the code duplication below enough
 	// for a subclass-of-QTableWidget based approach?
 
@@ -134,25 +236,66 @@ void Inspector::clear()
 	functionTable->setItem(0, 0, emptyItem);
 	functionTable->resizeColumnsToContents();
 
-	// Treeview gets cleared in updateTree()
+	// the tree of the previous run is released when the next one is parsed
+	treeModel->setRoot(nullptr);
 	disable();
 }
 
 
 void Inspector::updateVariable(const QString& name, const Value& value)
 {
-	// Check if the variable has already been added to the table
+	pendingVariables.insert(name, value);
+	if (!flushTimer->isActive()) flushTimer->start(FLUSH_INTERVAL);
+}
+
+void Inspector::updateFunction(const QString& name, const QStringList& parameters)
+{
+	pendingFunctions.insert(name, parameters);
+	if (!flushTimer->isActive()) flushTimer->start(FLUSH_INTERVAL);
+}
+
+void Inspector::flush()
+{
+	flushTimer->stop();
+
+	// sorting and resizing is done once for all the changes
+	if (!pendingVariables.isEmpty()) {
+		for (QHash<QString, Value>::const_iterator i = pendingVariables.constBegin(); i != pendingVariables.constEnd(); ++i)
+			showVariable(i.key(), i.value());
+		pendingVariables.clear();
+		variableTable->sortItems(0);
+		variableTable->resizeColumnsToContents();
+		variableTable->setEnabled(true);
+	}
+
+	if (!pendingFunctions.isEmpty()) {
+		for (QHash<QString, QStringList>::const_iterator i = pendingFunctions.constBegin(); i != pendingFunctions.constEnd(); ++i)
+			showFunction(i.key(), i.value());
+		pendingFunctions.clear();
+		functionTable->sortItems(0);
+		functionTable->resizeColumnsToContents();
+		functionTable->setEnabled(true);
+	}
+}
+
+void Inspector::showVariable(const QString& name, const Value& value)
+{
+	// Check if the variable has already been added to the table, its items are reused
 	int row = findVariable(name);
-	if (row == -1) {
-		// We are dealing with a new variable
-		if (variableTableEmpty) {  // Check whether we have to add a new row
-			variableTableEmpty = false;
-		} else {
-			variableTable->insertRow(0);
-		}
-		row = 0;
+	if (row != -1) {
+		variableTable->item(row, 1)->setText(value.string());
+		setTypeItem(variableTable->item(row, 2), value);
+		return;
 	}
 
+	// We are dealing with a new variable
+	if (variableTableEmpty) {  // Check whether we have to add a new row
+		variableTableEmpty = false;
+	} else {
+		variableTable->insertRow(0);
+	}
+	row = 0;
+
 	QTableWidgetItem* nameItem;
 	nameItem = new QTableWidgetItem(name);
 	nameItem->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
@@ -170,52 +313,40 @@ void Inspector::updateVariable(const QString& name, const Value& value)
 // 	valueItem->setFont(format->font());
 // 	valueItem->setForeground(format->foreground());
 
-	QTableWidgetItem* typeItem;
+	QTableWidgetItem* typeItem = new QTableWidgetItem();
+	setTypeItem(typeItem, value);
+	typeItem->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
+	variableTable->setItem(row, 1, valueItem);
+	variableTable->setItem(row, 2, typeItem);
+}
+
+void Inspector::setTypeItem(QTableWidgetItem* typeItem, const Value& value)
+{
+	QFont font = typeItem->font();
+	font.setItalic(value.type() == Value::Empty);
+	typeItem->setFont(font);
 	switch (value.type()) {
-		case Value::Empty: {
-                        typeItem  = new QTableWidgetItem(i18nc("undefined type of a variable","empty"));
-			QFont font = typeItem->font();
-			font.setItalic(true);
-			typeItem->setFont(font);
-			}
+		case Value::Empty:
+			typeItem->setText(i18nc("undefined type of a variable","empty"));
 			break;
 		case Value::Bool:
-			typeItem  = new QTableWidgetItem(i18n("boolean"));
+			typeItem->setText(i18n("boolean"));
 			break;
 		case Value::Number:
-			typeItem  = new QTableWidgetItem(i18n("number"));
+			typeItem->setText(i18n("number"));
 			break;
 		case Value::String:
-			typeItem  = new QTableWidgetItem(i18n("string"));
+			typeItem->setText(i18n("string"));
 			break;
 		default:
 			// should never happen
-			typeItem  = new QTableWidgetItem("ERROR! please report to KTurtle developers");
+			typeItem->setText("ERROR! please report to KTurtle developers");
 			break;
 	}
-	typeItem->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
-	variableTable->setItem(row, 1, valueItem);
-	variableTable->setItem(row, 2, typeItem);
-
-	variableTable->sortItems(0);
-	variableTable->resizeColumnsToContents();
-	variableTable->setEnabled(true);
 }
 
-void Inspector::updateFunction(const QString& name, const QStringList& parameters)
+void Inspector::showFunction(const QString& name, const QStringList& parameters)
 {
-	// When there is already a the 'Nothing to show' line re-use that one and don't add another
-	if (functionTableEmpty) {
-		functionTableEmpty = false;
-	} else {
-		functionTable->insertRow(0);
-	}
-
-	QTableWidgetItem* nameItem = new QTableWidgetItem(name);
-	nameItem->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
-	functionTable->setItem(0, 0, nameItem);
-	functionMap[name] = nameItem;
-
 	QTableWidgetItem* paramItem;
 	if (parameters.empty()) {
 		paramItem = new QTableWidgetItem(i18n("None"));
@@ -226,45 +357,34 @@ void Inspector::updateFunction(const QString& name, const QStringList& parameter
 		QString paramList = parameters.join(Translator::instance()->default2localized(QString(",")));
 		paramItem = new QTableWidgetItem(paramList);
 	}
-	
 	paramItem->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
-	functionTable->setItem(0, 1, paramItem);
-	functionTable->sortItems(0);
-	functionTable->resizeColumnsToContents();
-	functionTable->setEnabled(true);
-}
 
-void Inspector::updateTree(TreeNode* rootNode)
-{
-	treeMap.clear();
-	treeView->clear();
-	QTreeWidgetItem* rootItem = walkTree(rootNode);
-	foreach (QTreeWidgetItem* item, rootItem->takeChildren()) {
-		treeView->addTopLevelItem(item);
+	// A function that is learned again keeps its row
+	QTableWidgetItem* nameItem = functionMap.value(name);
+	if (nameItem) {
+		functionTable->setItem(nameItem->row(), 1, paramItem);
+		return;
 	}
-	delete rootItem;
-	treeView->expandAll();
-	treeView->setEnabled(true);
+
+	// When there is already a the 'Nothing to show' line re-use that one and don't add another
+	if (functionTableEmpty) {
+		functionTableEmpty = false;
+	} else {
+		functionTable->insertRow(0);
+	}
+
+	nameItem = new QTableWidgetItem(name);
+	nameItem->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
+	functionTable->setItem(0, 0, nameItem);
+	functionMap[name] = nameItem;
+	functionTable->setItem(0, 1, paramItem);
 }
 
-QTreeWidgetItem* Inspector::walkTree(TreeNode* node)
+void Inspector::updateTree(TreeNode* rootNode)
 {
-	QTreeWidgetItem* result = new QTreeWidgetItem();
-	result->setText(0, node->token()->look());
-	QTextCharFormat* format = highlighter->tokenToFormat(node->token());
-	if (format) {
-		result->setForeground(0, format->foreground());
-		QFont font(QFontDatabase::systemFont(QFontDatabase::FixedFont));
-		font.setBold(format->font().bold());
-		result->setFont(0, font);
-	}
-	treeMap[node] = result;
-	if (node->hasChildren()) {
-		for (uint i = 0; i < node->childCount(); i++) {
-			result->addChild(walkTree(node->child(i)));
-		}
-	}
-	return result;
+	// the rows are made when they are expanded, so big trees are shown collapsed
+	treeModel->setRoot(rootNode);
+	treeView->setEnabled(rootNode != nullptr);
 }
 
 int Inspector::findVariable(const QString& name)
@@ -299,18 +419,14 @@ void Inspector::markFunction(const QString& name)
 
 void Inspector::markTreeNode(TreeNode* node)
 {
-// 	//qDebug() << treeMap[node]->text(0);
-	clearTreeMark();
-	currentlyMarkedTreeItem = treeMap[node];
-	previousTreeBackground = currentlyMarkedTreeItem->background(0);
-	currentlyMarkedTreeItem->setBackground(0, QBrush(WORD_HIGHLIGHT_COLOR));
+	treeModel->setMarked(node);
+	// only the rows on the path to the node are expanded
+	treeView->scrollTo(treeModel->indexOf(node));
 }
 
 void Inspector::clearTreeMark()
 {
-	if (!currentlyMarkedTreeItem) return;
-	currentlyMarkedTreeItem->setBackground(0, previousTreeBackground);
-	currentlyMarkedTreeItem = nullptr;
+	treeModel->setMarked(nullptr);
 }
 
 void Inspector::clearAllMarks()
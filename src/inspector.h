@@ -20,6 +20,8 @@
 #ifndef _INSPECTOR_H_
 #define _INSPECTOR_H_
 
+#include <QAbstractItemModel>
+#include <QFont>
 #include <QFrame>
 #include <QHash>
 
@@ -32,8 +34,46 @@ class QHBoxLayout;
 class QTableWidget;
 class QTableWidgetItem;
 class QTabWidget;
-class QTreeWidget;
-class QTreeWidgetItem;
+class QTimer;
+class QTreeView;
+
+
+/**
+ * @short The node tree of the Interpreter, as a model for the tree view of the Inspector.
+ * The rows are made by the view when they are expanded, the TreeNodes are not copied.
+ * A TreeNode knows its index in its parent, so the index of a node is found in constant time.
+ */
+class TreeModel : public QAbstractItemModel
+{
+	Q_OBJECT
+
+	public:
+		TreeModel(Highlighter* highlighter, QObject* parent = nullptr);
+
+		/// Shows the tree of @p rootNode (without the root itself), zero for no tree; it has to stay valid until the next call
+		void setRoot(TreeNode* rootNode);
+		/// Gives @p node the background of the current word, zero to remove it
+		void setMarked(TreeNode* node);
+		/// @returns the index of @p node
+		QModelIndex indexOf(TreeNode* node) const;
+
+		QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const Q_DECL_OVERRIDE;
+		QModelIndex parent(const QModelIndex& index) const Q_DECL_OVERRIDE;
+		int rowCount(const QModelIndex& parent = QModelIndex()) const Q_DECL_OVERRIDE;
+		int columnCount(const QModelIndex& parent = QModelIndex()) const Q_DECL_OVERRIDE;
+		QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const Q_DECL_OVERRIDE;
+
+	private:
+		TreeNode* nodeAt(const QModelIndex& index) const {
+			return index.isValid() ? static_cast<TreeNode*>(index.internalPointer()) : root;
+		}
+
+		Highlighter *highlighter;
+		TreeNode    *root;
+		TreeNode    *marked;
+		QFont        font;
+		QFont        boldFont;
+};
 
 
 class Inspector : public QFrame
@@ -48,8 +88,11 @@ class Inspector : public QFrame
 
 
 	public slots:
+		/// Changes of variables and functions are collected, and shown by flush() at most once per frame
 		void updateVariable(const QString& name, const Value& value);
 		void updateFunction(const QString& name, const QStringList& parameters);
+		/// Shows the collected changes right away, used when the execution pauses or finishes
+		void flush();
 		void updateTree(TreeNode* rootNode);
 
 		void markVariable(const QString&);
@@ -63,7 +106,9 @@ class Inspector : public QFrame
 
 	private:
 		int findVariable(const QString& name);
-		QTreeWidgetItem* walkTree(TreeNode* node);
+		void showVariable(const QString& name, const Value& value);
+		void showFunction(const QString& name, const QStringList& parameters);
+		void setTypeItem(QTableWidgetItem* typeItem, const Value& value);
 
 		void clearTreeMark();
 
@@ -72,8 +117,11 @@ class Inspector : public QFrame
 		// map the names of the variables/functions to their respective items in the tabelwidget
 		QHash<QString, QTableWidgetItem*> variableMap;
 		QHash<QString, QTableWidgetItem*> functionMap;
-		// map the treenodes to their respective items in the treewidget
-		QHash<TreeNode*, QTreeWidgetItem*> treeMap;
+
+		// the changes that are not shown yet, only the last one of each name counts
+		QHash<QString, Value>       pendingVariables;
+		QHash<QString, QStringList> pendingFunctions;
+		QTimer       *flushTimer;
 
 		QHBoxLayout  *mainLayout;
 		QTabWidget   *tabWidget;
@@ -88,10 +136,8 @@ class Inspector : public QFrame
 
 		QWidget      *treeTab;
 		QHBoxLayout  *treeLayout;
-		QTreeWidget  *treeView;
-
-		QBrush previousTreeBackground;
-		QTreeWidgetItem *currentlyMarkedTreeItem;
+		QTreeView    *treeView;
+		TreeModel    *treeModel;
 
 		bool         variableTableEmpty;
 		bool         functionTableEmpty;
@@ -0,0 +1,258 @@
+/*
+	Copyright (C) 2026 agent <agent AT local>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public
+	License as published by the Free Software Foundation; either
+	version 2 of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to the Free
+	Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+	Boston, MA 02110-1301, USA.
+*/
+
+#include "analyzer.h"
+
+#include <QMutexLocker>
+
+
+
+Analyzer::Analyzer(QObject* parent)
+	: QThread(parent), stopping(false)
+{
+	lines << QString();
+	Chunk chunk;
+	chunk.lineCount = 1;
+	chunk.dirty = false;
+	chunks << chunk;
+
+	tokenizer = new Tokenizer();
+	parser    = new Parser();
+	arena     = new Arena();
+}
+
+Analyzer::~Analyzer()
+{
+	stop();
+	delete tokenizer;
+	delete parser;
+	delete arena;
+}
+
+
+ErrorList Analyzer::errors() const
+{
+	QMutexLocker locker(&mutex);
+	return foundErrors;
+}
+
+void Analyzer::stop()
+{
+	{
+		QMutexLocker locker(&mutex);
+		stopping = true;
+		changed.wakeOne();
+	}
+	wait();
+	stopping = false;
+}
+
+void Analyzer::setCode(const QString& code)
+{
+	Change change;
+	change.firstLine    = 0;
+	change.removedLines = -1;  // all of them
+	change.addedLines   = code.split('\n');
+	queueChange(change);
+}
+
+void Analyzer::changeLines(int firstLine, int removedLines, const QStringList& addedLines)
+{
+	Change change;
+	change.firstLine    = firstLine;
+	change.removedLines = removedLines;
+	change.addedLines   = addedLines;
+	queueChange(change);
+}
+
+void Analyzer::queueChange(const Change& change)
+{
+	{
+		QMutexLocker locker(&mutex);
+		changes.append(change);
+		changed.wakeOne();
+	}
+	if (!isRunning())
+		start(QThread::LowPriority);
+}
+
+
+void Analyzer::run()
+{
+	while (true) {
+		QList<Change> pending;
+		{
+			QMutexLocker locker(&mutex);
+			while (changes.isEmpty() && !stopping)
+				changed.wait(&mutex);
+			if (stopping) return;
+			pending.swap(changes);
+		}
+
+		foreach (const Change& change, pending)
+			applyChange(change);
+		analyze();
+
+		ErrorList errors;
+		int line = 0;
+		foreach (const Chunk& chunk, chunks) {
+			foreach (const ErrorMessage& error, chunk.errors)
+				errors.append(moveError(error, line));
+			line += chunk.lineCount;
+		}
+
+		bool done;
+		{
+			QMutexLocker locker(&mutex);
+			foundErrors = errors;
+			done = changes.isEmpty();
+		}
+		if (done) emit analyzed();  // otherwise the next changes are analyzed first
+	}
+}
+
+
+void Analyzer::applyChange(const Change& change)
+{
+	Chunk chunk;
+	chunk.dirty = true;
+
+	if (change.removedLines < 0 || chunks.isEmpty() || change.firstLine + change.removedLines > lines.size()) {
+		// all of the code changed (or the change does not fit, which should not happen)
+		lines = change.addedLines;
+		chunk.lineCount = lines.size();
+		chunks.clear();
+		chunks << chunk;
+		return;
+	}
+
+	// find the chunks with the first and the last changed line, an insertion changes the chunk it is inserted in
+	int first = 0;
+	int firstLine = 0;
+	while (first < chunks.size() - 1 && firstLine + chunks.at(first).lineCount <= change.firstLine)
+		firstLine += chunks.at(first++).lineCount;
+	int lastLine = change.firstLine + qMax(1, change.removedLines) - 1;
+	int last = first;
+	int endLine = firstLine + chunks.at(first).lineCount;
+	while (last < chunks.size() - 1 && endLine <= lastLine)
+		endLine += chunks.at(++last).lineCount;
+
+	// replacing the lines one by one is quadratic for large pastes
+	lines = lines.mid(0, change.firstLine) + change.addedLines + lines.mid(change.firstLine + change.removedLines);
+
+	chunk.lineCount = endLine - firstLine - change.removedLines + change.addedLines.size();
+	chunks.erase(chunks.begin() + first, chunks.begin() + last + 1);
+	if (chunk.lineCount > 0)
+		chunks.insert(first, chunk);
+}
+
+void Analyzer::analyze()
+{
+	int line = 0;          // the first line of chunk i
+	int previousLine = 0;  // the first line of chunk i - 1
+	int i = 0;
+	while (i < chunks.size()) {
+		if (!chunks.at(i).dirty) {
+			previousLine = line;
+			line += chunks.at(i).lineCount;
+			i++;
+			continue;
+		}
+
+		// the closing brace at the end of the chunk before can be followed by an else in this one
+		int first = qMax(0, i - 1);
+		int firstLine = i > 0 ? previousLine : 0;
+		int last = i;
+		int endLine = line + chunks.at(i).lineCount;
+		while (last < chunks.size() - 1 && chunks.at(last + 1).dirty)
+			endLine += chunks.at(++last).lineCount;
+
+		QList<Chunk> parsed;
+		while (!parseLines(firstLine, endLine, &parsed) && last < chunks.size() - 1) {
+			// take in the lines that may close the scope, twice as many each time
+			int extraLines = endLine - firstLine;
+			while (extraLines > 0 && last < chunks.size() - 1) {
+				extraLines -= chunks.at(++last).lineCount;
+				endLine += chunks.at(last).lineCount;
+			}
+		}
+
+		chunks.erase(chunks.begin() + first, chunks.begin() + last + 1);
+		for (int j = 0; j < parsed.size(); j++)
+			chunks.insert(first + j, parsed.at(j));
+		i = first + parsed.size();
+		line = endLine;
+		previousLine = parsed.isEmpty() ? firstLine : endLine - parsed.last().lineCount;
+	}
+}
+
+bool Analyzer::parseLines(int firstLine, int endLine, QList<Chunk>* parsed)
+{
+	parsed->clear();
+	Chunk chunk;
+	chunk.dirty = false;
+	int chunkLine = firstLine;  // the first line of the chunk that is being parsed
+	bool closed = true;
+
+	int line = firstLine;
+	while (line < endLine) {
+		// the Tokens and TreeNodes only live as long as this parse run
+		Arena::Activator activator(arena);
+		ErrorList errors;
+		tokenizer->initialize(QStringList(lines.mid(line, endLine - line)).join(QChar('\n')));
+		parser->initialize(tokenizer, &errors);
+
+		while (!parser->isFinished() && errors.isEmpty()) {
+			parser->parse();
+			// a statement of the main program starts a new chunk
+			int statementLine = line + parser->nextRow() - 1;
+			if (parser->isAtRootScope() && errors.isEmpty() && statementLine > chunkLine && statementLine < endLine) {
+				chunk.lineCount = statementLine - chunkLine;
+				parsed->append(chunk);
+				chunkLine = statementLine;
+			}
+		}
+		closed = parser->isAtRootScope();
+
+		int nextLine = endLine;
+		if (!errors.isEmpty()) {
+			// the chunk ends at the line of the error, parsing goes on at the next line
+			nextLine = qBound(chunkLine, line + errors.last().token().endRow() - 1, endLine - 1) + 1;
+			foreach (const ErrorMessage& error, errors)
+				chunk.errors.append(moveError(error, line - chunkLine));
+			closed = true;
+		}
+		chunk.lineCount = nextLine - chunkLine;
+		parsed->append(chunk);
+		chunk.errors.clear();
+		chunkLine = nextLine;
+		line = nextLine;
+		arena->release();
+	}
+	return closed;
+}
+
+
+ErrorMessage Analyzer::moveError(const ErrorMessage& error, int rows)
+{
+	Token token = error.token();
+	token.setStartRow(token.startRow() + rows);
+	token.setEndRow(token.endRow() + rows);
+	return ErrorMessage(error.text(), token, error.code());
+}
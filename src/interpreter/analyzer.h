@@ -0,0 +1,144 @@
+/*
+	Copyright (C) 2026 agent <agent AT local>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public
+	License as published by the Free Software Foundation; either
+	version 2 of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to the Free
+	Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+	Boston, MA 02110-1301, USA.
+*/
+
+#ifndef _ANALYZER_H_
+#define _ANALYZER_H_
+
+#include <QMutex>
+#include <QStringList>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "arena.h"
+#include "errormsg.h"
+#include "parser.h"
+#include "tokenizer.h"
+
+
+
+/**
+ * @short Parses the code on a worker thread while it is edited, to find errors early.
+ *
+ * The Analyzer keeps a copy of the code as lines, split up in chunks. A chunk
+ * is a run of lines that starts with a statement of the main program (not in
+ * a scope), so every chunk can be parsed without the ones before it. With
+ * every chunk the errors that parsing it gave are kept.
+ *
+ * When lines are changed (see changeLines()) only the chunks that contain
+ * them, and the chunk before them (an else can follow its closing brace),
+ * are parsed again. When a scope is still open at the end of those chunks
+ * the next chunk is added, until the scope is closed. After an error the
+ * parsing continues on the next line, so more than one error can be found.
+ *
+ * The parsing is done on a worker thread that is started by the first change,
+ * the changes that come in while it is busy are handled together. analyzed()
+ * is emitted when all changes are handled, errors() then gives the errors.
+ */
+class Analyzer : public QThread
+{
+	Q_OBJECT
+
+	public:
+		/**
+		 * @short Constructor. The code is one empty line.
+		 */
+		explicit Analyzer(QObject* parent = 0);
+
+		/**
+		 * @short Destructor. Stops the worker thread.
+		 */
+		~Analyzer();
+
+		/// @returns the errors found by the last analysis, with the rows they have in the code
+		ErrorList    errors() const;
+
+		/**
+		 * @short Stops the worker thread, waiting for it to finish.
+		 * It is started again by the next change. Used when the Translator
+		 * changes its dictionary, which the worker thread uses.
+		 */
+		void         stop();
+
+
+	public slots:
+		/// Replaces all of the code, for instance when the dictionary changed
+		void         setCode(const QString& code);
+
+		/// Replaces @p removedLines lines starting at line @p firstLine (counted from zero) by @p addedLines
+		void         changeLines(int firstLine, int removedLines, const QStringList& addedLines);
+
+
+	signals:
+		/// Emitted by the worker thread when all changes are analyzed
+		void         analyzed();
+
+
+	protected:
+		void         run() override;
+
+
+	private:
+		/// A change of the code, as given to changeLines()
+		typedef struct {
+			int          firstLine;
+			int          removedLines;
+			QStringList  addedLines;
+		} Change;
+
+		/// A run of lines that can be parsed on its own
+		typedef struct {
+			int          lineCount;
+			bool         dirty;   // it has changed since it was parsed
+			ErrorList    errors;  // with rows counted from the first line of the chunk
+		} Chunk;
+
+		/// Adds @p change to the changes the worker thread handles next, and starts it when needed
+		void         queueChange(const Change& change);
+
+		/// Applies @p change to the lines, marking the chunks it touches dirty
+		void         applyChange(const Change& change);
+
+		/// Parses the dirty chunks again
+		void         analyze();
+
+		/**
+		 * Parses the lines from @p firstLine up to @p endLine and splits
+		 * them up in @p chunks. @returns FALSE when a scope is left open.
+		 */
+		bool         parseLines(int firstLine, int endLine, QList<Chunk>* chunks);
+
+		/// @returns a copy of @p error that is @p rows rows further down
+		static ErrorMessage moveError(const ErrorMessage& error, int rows);
+
+		mutable QMutex  mutex;      // guards the members up to the worker thread ones
+		QWaitCondition  changed;
+		QList<Change>   changes;
+		ErrorList       foundErrors;
+		bool            stopping;
+
+		// only used by the worker thread:
+		QStringList     lines;
+		QList<Chunk>    chunks;
+		Tokenizer      *tokenizer;
+		Parser         *parser;
+		Arena          *arena;      // for one parse run, the node tree is not kept
+};
+
+
+#endif  // _ANALYZER_H_
@@ -0,0 +1,160 @@
+/*
+	Copyright (C) 2026 agent <agent AT local>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public
+	License as published by the Free Software Foundation; either
+	version 2 of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to the Free
+	Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+	Boston, MA 02110-1301, USA.
+*/
+
+#include "arena.h"
+
+#include <cstdlib>
+#include <new>
+
+#include "token.h"
+#include "treenode.h"
+
+
+static const int    SLOTS_PER_BLOCK = 1024;
+static const size_t SLOT_ALIGNMENT  = sizeof(double);
+
+thread_local Arena* Arena::current = 0;
+
+
+Arena::Pool::Pool(size_t objectSize)
+	: usedBlocks(0), usedSlots(0), freeList(0)
+{
+	size_t size = sizeof(Slot) + objectSize;
+	slotSize = (size + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT * SLOT_ALIGNMENT;
+}
+
+Arena::Pool::~Pool()
+{
+	foreach (char* block, blocks) free(block);
+}
+
+
+Arena::Slot* Arena::Pool::slotAt(int block, int index) const
+{
+	return reinterpret_cast<Slot*>(blocks.at(block) + index * slotSize);
+}
+
+
+void* Arena::Pool::allocate()
+{
+	Slot* slot;
+	if (freeList != 0) {
+		slot = freeList;
+		freeList = slot->nextFree;
+	} else {
+		if (usedBlocks == 0 || usedSlots == SLOTS_PER_BLOCK) {
+			if (usedBlocks == blocks.size()) {
+				char* block = static_cast<char*>(malloc(SLOTS_PER_BLOCK * slotSize));
+				if (block == 0) throw std::bad_alloc();
+				blocks.append(block);
+			}
+			usedBlocks++;
+			usedSlots = 0;
+		}
+		slot = slotAt(usedBlocks - 1, usedSlots++);
+		slot->pool = this;
+	}
+	slot->nextFree = 0;
+	slot->alive    = true;
+	return slot + 1;
+}
+
+
+void Arena::Pool::recycle(Slot* slot)
+{
+	slot->alive    = false;
+	slot->nextFree = freeList;
+	freeList       = slot;
+}
+
+
+template <class T> void Arena::Pool::destroyAll()
+{
+	// first destroy everything, the slot headers stay valid so
+	// destructors can still use Arena::owns() on their members
+	for (int block = 0; block < usedBlocks; block++) {
+		int count = (block == usedBlocks - 1) ? usedSlots : SLOTS_PER_BLOCK;
+		for (int i = 0; i < count; i++) {
+			Slot* slot = slotAt(block, i);
+			if (slot->alive) reinterpret_cast<T*>(slot + 1)->~T();
+		}
+	}
+	usedBlocks = 0;
+	usedSlots  = 0;
+	freeList   = 0;
+}
+
+
+
+Arena::Arena()
+	: tokens(sizeof(Token)), treeNodes(sizeof(TreeNode))
+{
+}
+
+Arena::~Arena()
+{
+	release();
+}
+
+
+void Arena::release()
+{
+	// the nodes go first, they look at the slots of their tokens
+	treeNodes.destroyAll<TreeNode>();
+	tokens.destroyAll<Token>();
+}
+
+
+void* Arena::allocate(Pool* pool, size_t size)
+{
+	if (pool != 0) return pool->allocate();
+
+	Slot* slot = static_cast<Slot*>(malloc(sizeof(Slot) + size));
+	if (slot == 0) throw std::bad_alloc();
+	slot->pool = 0;
+	return slot + 1;
+}
+
+void* Arena::allocateToken(size_t size)
+{
+	// objects of derived classes do not fit the slots
+	return allocate(current != 0 && size == sizeof(Token) ? &current->tokens : 0, size);
+}
+
+void* Arena::allocateTreeNode(size_t size)
+{
+	return allocate(current != 0 && size == sizeof(TreeNode) ? &current->treeNodes : 0, size);
+}
+
+
+void Arena::deallocate(void* object)
+{
+	if (object == 0) return;
+	Slot* slot = static_cast<Slot*>(object) - 1;
+	if (slot->pool != 0)
+		slot->pool->recycle(slot);
+	else
+		free(slot);
+}
+
+
+bool Arena::owns(const void* object)
+{
+	return object != 0 && (static_cast<const Slot*>(object) - 1)->pool != 0;
+}
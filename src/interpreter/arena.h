@@ -0,0 +1,121 @@
+/*
+	Copyright (C) 2026 agent <agent AT local>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public
+	License as published by the Free Software Foundation; either
+	version 2 of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to the Free
+	Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+	Boston, MA 02110-1301, USA.
+*/
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <QVector>
+
+#include <cstddef>
+
+
+class Token;
+class TreeNode;
+
+
+/**
+ * @short Owns the Tokens and TreeNodes made during one parse run.
+ *
+ * While an Arena is active (see Arena::Activator) every Token and TreeNode
+ * that gets created is placed in a slot of a large block owned by the Arena,
+ * instead of being allocated on its own. Deleting such an object only puts
+ * its slot back on a free list, so the many short lived white space and
+ * comment Tokens are recycled right away.
+ *
+ * release() destroys all objects that are still alive in one linear pass
+ * over the blocks (no recursion through the node tree) and keeps the blocks
+ * for the next run.
+ *
+ * Tokens and TreeNodes created while no Arena is active (like the ones of the
+ * Highlighter) are allocated on the heap as before.
+ */
+class Arena
+{
+	public:
+		/**
+		 * @short Makes an Arena the active one for as long as it exists.
+		 * Restores the previously active Arena when it goes out of scope.
+		 */
+		class Activator
+		{
+			public:
+				explicit Activator(Arena* arena) : previous(Arena::current) { Arena::current = arena; }
+				~Activator() { Arena::current = previous; }
+			private:
+				Arena* previous;
+		};
+
+		Arena();
+		~Arena();
+
+		/// Destroys all objects still alive in the Arena, the memory is kept for reuse
+		void release();
+
+		/// Used by Token::operator new() and TreeNode::operator new()
+		static void* allocateToken(size_t size);
+		static void* allocateTreeNode(size_t size);
+
+		/// Used by Token::operator delete() and TreeNode::operator delete()
+		static void  deallocate(void* object);
+
+		/// @returns TRUE if @p object (a Token or TreeNode) lives in an Arena
+		static bool  owns(const void* object);
+
+
+	private:
+		class Pool;
+
+		/// Every object is preceded by this header
+		typedef struct Slot {
+			Pool       *pool;      // zero when allocated on the heap
+			Slot       *nextFree;  // next slot on the free list
+			bool        alive;
+		} Slot;
+
+		/// Fixed size slots for one type of object
+		class Pool
+		{
+			public:
+				explicit Pool(size_t objectSize);
+				~Pool();
+
+				void* allocate();
+				void  recycle(Slot* slot);
+				template <class T> void destroyAll();
+
+			private:
+				Slot* slotAt(int block, int index) const;
+
+				size_t            slotSize;
+				QVector<char*>    blocks;
+				int               usedBlocks;  // blocks with handed out slots
+				int               usedSlots;   // handed out slots in the last used block
+				Slot             *freeList;
+		};
+
+		static void* allocate(Pool* pool, size_t size);
+
+		static thread_local Arena* current;
+
+		Pool tokens;
+		Pool treeNodes;
+};
+
+
+#endif  // _ARENA_H_
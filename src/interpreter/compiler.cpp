@@ -0,0 +1,255 @@
+/*
+	Copyright (C) 2026 agent <agent AT local>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public
+	License as published by the Free Software Foundation; either
+	version 2 of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to the Free
+	Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+	Boston, MA 02110-1301, USA.
+*/
+
+#include "compiler.h"
+
+#include <QDebug>
+
+
+Program* Compiler::compile(TreeNode* rootNode)
+{
+	program = new Program;
+	learnNodes.clear();
+	breakJumps.clear();
+
+	compileBody(rootNode);
+	append(Halt, rootNode);
+
+	// the learned functions are placed after the main program, learn nodes
+	// found while compiling a function body are appended to the list
+	for (int i = 0; i < learnNodes.size(); i++) {
+		TreeNode* learnNode = learnNodes.at(i);
+		program->entries.insert(learnNode, program->code.size());
+		compileBody(learnNode->child(2));
+		append(Return, learnNode, 0);  // falling off the end of the function
+	}
+
+	Program* result = program;
+	program = 0;
+	return result;
+}
+
+
+void Compiler::compileBody(TreeNode* node)
+{
+	if (node == 0) return;
+
+	if (node->token()->type() != Token::Scope && node->token()->type() != Token::Root) {
+		compileStatement(node);
+		return;
+	}
+
+	for (uint i = 0; i < node->childCount(); i++)
+		compileStatement(node->child(i));
+}
+
+
+void Compiler::compileStatement(TreeNode* node)
+{
+	switch (node->token()->type()) {
+		case Token::Scope:
+			compileBody(node);
+			break;
+
+		case Token::Else:
+			compileBody(node->child(0));
+			break;
+
+		case Token::If:     compileIf(node);     break;
+		case Token::Repeat: compileRepeat(node); break;
+		case Token::While:  compileWhile(node);  break;
+		case Token::ForTo:  compileForTo(node);  break;
+
+		case Token::Break:
+			// a break outside a loop is ignored
+			if (!breakJumps.isEmpty())
+				breakJumps.last().append(append(Jump, node));
+			break;
+
+		case Token::Return:
+			append(Return, node, compileArguments(node));
+			break;
+
+		case Token::Learn:
+			// registering the function is done by executing the learn node,
+			// its body is compiled after the main program
+			learnNodes.append(node);
+			append(Execute, node, 0);
+			break;
+
+		case Token::Assign:
+			if (node->childCount() != 2) {
+				append(Execute, node, compileArguments(node));  // the Executer reports the error
+				break;
+			}
+			compileExpression(node->child(1));
+			append(Assign, node);
+			break;
+
+		case Token::FunctionCall:
+			append(Call, node, compileArguments(node));
+			append(Pop, node);
+			break;
+
+		case Token::ScopeClose:
+		case Token::EndOfLine:
+		case Token::EndOfInput:
+			break;  // nothing to execute
+
+		default:
+			append(Execute, node, compileArguments(node));
+			break;
+	}
+}
+
+
+void Compiler::compileExpression(TreeNode* node)
+{
+	switch (node->token()->type()) {
+		case Token::String:
+		case Token::Number:
+		case Token::True:
+		case Token::False:
+			append(Constant, node);
+			break;
+
+		case Token::Variable:
+			append(Load, node);
+			break;
+
+		case Token::FunctionCall:
+			append(Call, node, compileArguments(node));
+			break;
+
+		case Token::Scope:
+		case Token::Else:
+		case Token::If:
+		case Token::Repeat:
+		case Token::While:
+		case Token::ForTo:
+		case Token::Break:
+		case Token::Return:
+		case Token::Learn:
+		case Token::Assign:
+		case Token::ScopeClose:
+		case Token::EndOfLine:
+		case Token::EndOfInput:
+			// statements used as an expression do not yield a value
+			compileStatement(node);
+			append(Empty, node);
+			break;
+
+		default:
+			append(Evaluate, node, compileArguments(node));
+			break;
+	}
+}
+
+
+int Compiler::compileArguments(TreeNode* node)
+{
+	for (uint i = 0; i < node->childCount(); i++)
+		compileExpression(node->child(i));
+	return node->childCount();
+}
+
+
+void Compiler::compileIf(TreeNode* node)
+{
+	compileExpression(node->child(0));
+	int jumpToElse = append(JumpIfFalse, node);
+	compileBody(node->child(1));
+	if (node->childCount() >= 3) {
+		int jumpToEnd = append(Jump, node);
+		patch(jumpToElse);
+		compileBody(node->child(2));  // the else part
+		patch(jumpToEnd);
+	} else {
+		patch(jumpToElse);
+	}
+}
+
+
+void Compiler::compileRepeat(TreeNode* node)
+{
+	compileExpression(node->child(0));
+	int enter = append(RepeatEnter, node);
+	int check = append(RepeatNext, node);
+	breakJumps.append(QList<int>());
+	compileBody(node->child(1));
+	append(Jump, node, check);
+	patchBreaks();
+	append(LeaveLoop, node);
+	patch(enter);
+	patch(check);
+}
+
+
+void Compiler::compileWhile(TreeNode* node)
+{
+	int check = program->code.size();
+	compileExpression(node->child(0));
+	int exit = append(JumpIfFalse, node);
+	breakJumps.append(QList<int>());
+	compileBody(node->child(1));
+	append(Jump, node, check);
+	patchBreaks();
+	patch(exit);
+}
+
+
+void Compiler::compileForTo(TreeNode* node)
+{
+	// child 0 is the variable, 1-3 the start, end and step expressions, and 4 the body;
+	// the expressions are evaluated again before every check, just like in the node tree
+	for (int i = 1; i <= 3; i++) compileExpression(node->child(i));
+	append(ForEnter, node);
+	int check = append(ForCheck, node);
+	breakJumps.append(QList<int>());
+	compileBody(node->child(4));
+	for (int i = 1; i <= 3; i++) compileExpression(node->child(i));
+	append(Jump, node, check);
+	patchBreaks();
+	append(LeaveLoop, node);
+	patch(check);
+}
+
+
+int Compiler::append(int opcode, TreeNode* node, int argument)
+{
+	Instruction instruction;
+	instruction.opcode   = opcode;
+	instruction.argument = argument;
+	instruction.node     = node;
+	program->code.append(instruction);
+	return program->code.size() - 1;
+}
+
+
+void Compiler::patch(int address)
+{
+	program->code[address].argument = program->code.size();
+}
+
+
+void Compiler::patchBreaks()
+{
+	foreach (int address, breakJumps.takeLast())
+		patch(address);
+}
@@ -0,0 +1,134 @@
+/*
+	Copyright (C) 2026 agent <agent AT local>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public
+	License as published by the Free Software Foundation; either
+	version 2 of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to the Free
+	Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+	Boston, MA 02110-1301, USA.
+*/
+
+#ifndef _COMPILER_H_
+#define _COMPILER_H_
+
+#include <QHash>
+#include <QList>
+#include <QVector>
+
+#include "treenode.h"
+
+
+
+// some typedefs and structs for the compiled program:
+
+typedef struct {
+	int            opcode;   // one of the Compiler::Opcode values
+	int            argument; // jump target or amount of argument values, depending on the opcode
+	TreeNode*      node;     // pointer to the node the instruction was compiled from
+} Instruction;
+
+typedef struct {
+	QVector<Instruction>  code;    // the instructions, execution starts at the first one
+	QHash<TreeNode*, int> entries; // address of the body of each learn node
+} Program;
+
+
+
+/**
+ * @short Lowers the node tree, as yielded by the Parser, to a flat Program.
+ *
+ * The Compiler walks the node tree once and emits a linear list of
+ * instructions for a stack machine. Loops and ifs become jumps, the
+ * intermediate results of expressions are kept on a value stack instead of
+ * on the nodes. The bodies of learned functions are placed after the main
+ * program.
+ *
+ * The Executer executes the Program when it is initialized with one, the
+ * instructions keep a pointer to the node they stem from so errors and
+ * signals are reported just like when the node tree is executed.
+ */
+class Compiler
+{
+	public:
+		enum Opcode
+		{
+			Halt,         // stops execution
+			Constant,     // pushes the value of the node
+			Empty,        // pushes an empty value
+			Load,         // pushes the value of the variable of the node
+			Assign,       // pops a value and assigns it to the variable of the node's first child
+			Execute,      // pops 'argument' values and executes the node with them
+			Evaluate,     // like Execute, but pushes the value of the node afterwards
+			Call,         // pops 'argument' values and calls the learned function of the node
+			Return,       // pops 'argument' values and returns the first from the function
+			Pop,          // drops one value
+			Jump,         // continues at 'argument'
+			JumpIfFalse,  // pops a value, continues at 'argument' when it is false
+			RepeatEnter,  // pops the count of a repeat loop, continues at 'argument' when it is not positive
+			RepeatNext,   // counts down a repeat loop, continues at 'argument' when done
+			ForEnter,     // sets the variable of a for loop to its start value
+			ForCheck,     // pops start, end and step, continues at 'argument' when the for loop is done
+			LeaveLoop     // drops the state of the innermost loop (after a break)
+		};
+
+		/**
+		 * @short Constructor. Does nothing special.
+		 */
+		Compiler() : program(0) {}
+
+		/**
+		 * @short Destructor. Does nothing special.
+		 */
+		~Compiler() {}
+
+		/**
+		 * @short Compiles the node tree starting at @p rootNode.
+		 * The Program keeps pointers to the nodes, so the node tree has to
+		 * outlive it.
+		 * @returns a newly allocated Program, owned by the caller
+		 */
+		Program* compile(TreeNode* rootNode);
+
+
+	private:
+		/// Compiles a scope (its children) or a single statement
+		void         compileBody(TreeNode* node);
+		/// Compiles a node of which the value is not used
+		void         compileStatement(TreeNode* node);
+		/// Compiles a node that leaves exactly one value on the stack
+		void         compileExpression(TreeNode* node);
+		/// Compiles all children of @p node as expressions, @returns the amount of them
+		int          compileArguments(TreeNode* node);
+		/// Compiles loops and ifs
+		void         compileIf(TreeNode* node);
+		void         compileRepeat(TreeNode* node);
+		void         compileWhile(TreeNode* node);
+		void         compileForTo(TreeNode* node);
+
+		/// Appends an instruction, @returns its address
+		int          append(int opcode, TreeNode* node, int argument = 0);
+		/// Sets the jump target of the instruction at @p address to the next address
+		void         patch(int address);
+		/// Sets the jump target of all breaks of the innermost loop to the next address
+		void         patchBreaks();
+
+		Program                *program;
+
+		/// The learn nodes of which the bodies still have to be compiled
+		QList<TreeNode*>        learnNodes;
+
+		/// For each loop that is being compiled, the addresses of its break jumps (innermost last)
+		QList<QList<int> >      breakJumps;
+};
+
+
+#endif  // _COMPILER_H_
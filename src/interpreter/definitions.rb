@@ -75,6 +75,13 @@ new_item()
 		returnValue = 0;
 		return;
 	}
+	// a scope of its own is executed once, like the scope of an if
+	if (activeLoop(node) != 0) {
+		// we are back from the scope
+		leaveLoop(node);
+		return;
+	}
+	enterLoop(node);
 	newScope = node;
 EOS
 parse_item()
@@ -128,16 +135,14 @@ EOS
 			aValueIsNeeded = false;
 		}
 	}
-	if (!functionStack.isEmpty() && 
-	    functionStack.top().variableTable->contains(node->token()->look())) {
-		// //qDebug() << "exists locally";
-		node->setValue( (*functionStack.top().variableTable)[node->token()->look()] );
-	} else if (globalVariableTable.contains(node->token()->look())) {
-		// //qDebug() << "exists globally";
-		node->setValue(globalVariableTable[node->token()->look()]);
+	// the local variable is found first, see readVariable()
+	VariableSlot* variable = readVariable(node);
+	if (variable != 0) {
+		node->setValue(variable->value);
 	} else if (aValueIsNeeded)
 	{
 		addError(i18n("The variable '%1' was used without first being assigned to a value", node->token()->look()), *node->token(), 0);
+		specializing = false;  // the node keeps its old value, see executeNumeric()
 	}
 EOS
 parse_item()
@@ -169,18 +174,11 @@ EOS
 		return;
 	}
 
-	if (!functionTable.contains(node->token()->look())) {
+	TreeNode* learnNode = linkFunction(node);
+	if (learnNode == 0) {
 		addError(i18n("An unknown function named '%1' was called", node->token()->look()), *node->token(), 0);
 		return;
 	}
-	
-	CalledFunction c;
-	c.function      = node;
-	c.variableTable = new VariableTable();
-	functionStack.push(c);
-	// //qDebug() << "==> functionCalled!";
-	
-	TreeNode* learnNode = functionTable[node->token()->look()];
 
 	// if the parameter numbers are not equal...
 	if (node->childCount() != learnNode->child(1)->childCount()) {
@@ -193,10 +191,33 @@ EOS
 			*node->token(), 0);
 		return;
 	}
-		
+
+	MemoTable* memo = memoTable(learnNode);
+	QByteArray key;
+	if (memo != 0) {
+		for (uint i = 0; i < node->childCount(); i++)
+			appendMemoKey(key, *node->child(i)->value());
+		MemoTable::const_iterator result = memo->constFind(key);
+		if (result != memo->constEnd()) {
+			// called before with these arguments
+			if (result.value().type() == Value::Empty)
+				node->setNullValue();
+			else
+				node->setValue(result.value());
+			return;
+		}
+	}
+
+	if (!pushFrame(node, learnNode)) return;
+	functionStack.top().memoTable = memo;
+	functionStack.top().memoKey   = key;
+	// //qDebug() << "==> functionCalled!";
+
+	VariableTable* frame = functionStack.top().variableTable;
 	for (uint i = 0; i < node->childCount(); i++) {
-		functionStack.top().variableTable->insert(learnNode->child(1)->child(i)->token()->look(), node->child(i)->value());
-		// //qDebug() << "inserted variable " << learnNode->child(1)->child(i)->token()->look() << " on function stack";
+		VariableSlot& argument = (*frame)[learnNode->child(1)->child(i)->localSlot()];
+		argument.value    = node->child(i)->value();
+		argument.assigned = true;
 	}
 	newScope = learnNode->child(2);
 EOS
@@ -368,19 +389,19 @@ new_item()
 EOS
 @e_def =
 <<EOS
-	QString id = QString("__%1_%2").arg(node->token()->look()).arg((quintptr)node);
-	if (currentVariableTable()->contains(id)) {
-		currentVariableTable()->remove(id);
+	if (activeLoop(node) != 0) {
+		// we are back from the scope
+		leaveLoop(node);
 		return;
 	}
 	
 	if (node->child(0)->value()->boolean()) {
-		// store a empty Value just to know we executed once
-		currentVariableTable()->insert(id, Value());
+		// push a state just to know we executed once
+		enterLoop(node);
 		newScope = node->child(1);
 	} else {
 		if (node->childCount() >= 3) {
-			currentVariableTable()->insert(id, Value());
+			enterLoop(node);
 			newScope = node->child(2); // execute the else part
 		}
 	}
@@ -428,28 +449,26 @@ new_item()
 @p_def = p_def_repeat_while
 @e_def =
 <<EOS
-	QString id = QString("__%1_%2").arg(node->token()->look()).arg((quintptr)node);
-
 	if(breaking) {
 		breaking = false;
-		currentVariableTable()->remove(id);
+		leaveLoop(node);
 		return;
 	}
 
-	// the iteration state is stored on the variable table
-	if (currentVariableTable()->contains(id)) {
-		int currentCount = ROUND2INT((*currentVariableTable())[id].number());
-		if (currentCount > 0) {
-			(*currentVariableTable())[id].setNumber(currentCount - 1);
+	// the iteration state is stored on the loop stack
+	LoopState* loop = activeLoop(node);
+	if (loop != 0) {
+		if (loop->count > 0) {
+			loop->count--;
 		} else {
-			currentVariableTable()->remove(id);
+			leaveLoop(node);
 			return;
 		}
 	} else {
-		if(ROUND2INT(node->child(0)->value()->number())<=0) // handle 'repeat 0'
+		if(static_cast<int>(round(node->child(0)->value()->number()))<=0) // handle 'repeat 0'
 			return;
 		
-		currentVariableTable()->insert(id, Value((double)(ROUND2INT(node->child(0)->value()->number()) - 1)));
+		enterLoop(node, round(node->child(0)->value()->number()) - 1.0);
 	}
 	newScope = node->child(1);
 EOS
@@ -468,26 +487,24 @@ new_item()
 	// so we do the following on every call to executeWhile:
 	//     exec scope, exec expression, exec scope, exec expression, ...
 
-	QString id = QString("__%1_%2").arg(node->token()->look()).arg((quintptr)node);
-
 	if (breaking) {
 		// We hit a break command while executing the scope
 		breaking = false; // Not breaking anymore
-		currentVariableTable()->remove(id); // remove the value (cleanup)
+		leaveLoop(node); // pop the loop state (cleanup)
 		return; // Move to the next sibbling
 	}
 
-	if (currentVariableTable()->contains(id)) {
+	if (activeLoop(node) != 0) {
 		newScope = node; // re-execute the expression
-		currentVariableTable()->remove(id);
+		leaveLoop(node);
 		return;
 	}
-	currentVariableTable()->insert(id, Value()); // store a empty Value just to know we executed once
 
-	if (node->child(0)->value()->boolean())
+	if (node->child(0)->value()->boolean()) {
+		enterLoop(node); // push a state just to know we executed once
 		newScope = node->child(1); // (re-)execute the scope
-	else
-		currentVariableTable()->remove(id); // clean-up, keep currenNode on currentNode so the next sibling we be run next
+	}
+	// otherwise keep currenNode on currentNode so the next sibling we be run next
 EOS
 parse_item()
 
@@ -550,43 +567,32 @@ new_item()
 	// after one iteration the expression is not re-executed.
 	// so we do: exec scope, exec expressions, exec scope, exec expressions, ...
 
-	//TODO: We have the cleanup part twice (after breaking and after the last iteration
-	// perhaps clean it up by putting in in one place?
+	if(breaking) {
+		breaking = false;
+		leaveLoop(node);
+		return;
+	}
 
 	bool firstIteration = false;
-	if (functionStack.isEmpty() || functionStack.top().function != node) {
+	LoopState* loop = activeLoop(node);
+	if (loop == 0) {
 		// if this for loop is called for the first time...
-		CalledFunction c;
-		c.function      = node;
-		// TODO: Find a better solution then this for nested for loops
-		//c.variableTable = new VariableTable();
-		c.variableTable = currentVariableTable();
-		functionStack.push(c);
-
-		currentVariableTable()->insert(node->child(0)->token()->look(), Value(node->child(1)->value()->number()));
+		loop = enterLoop(node);
+		VariableSlot* variable = currentVariable(node->child(0));
+		variable->value    = Value(node->child(1)->value()->number());
+		variable->assigned = true;
 		firstIteration = true;
 	}
 
-	QString id = QString("__%1_%2").arg(node->token()->look()).arg((quintptr)node);
-
-	if(breaking) {
-		breaking = false;
-		//delete functionStack.top().variableTable;
-		functionStack.pop();
-		// if we don't delete the functionStack's varibleTable any more
-		// do remove the for loops id..
-		currentVariableTable()->remove(id);
-		return;
-	}
-
-	if (currentVariableTable()->contains(id)) {
+	if (loop->entered) {
 		newScope = node; // re-execute the expressions
-		currentVariableTable()->remove(id);
+		loop->entered = false;
 		return;
 	}
-	currentVariableTable()->insert(id, Value()); // store a empty Value just to know we executed once
+	loop->entered = true; // just to know we executed once
 
-	double currentCount   = (*currentVariableTable())[node->child(0)->token()->look()].number();
+	Value& variable       = currentVariable(node->child(0))->value;
+	double currentCount   = variable.number();
 	double startCondition = node->child(1)->value()->number();
 	double endCondition   = node->child(2)->value()->number();
 	double step           = node->child(3)->value()->number();
@@ -595,15 +601,11 @@ new_item()
 	    (startCondition > endCondition && currentCount + step >= endCondition && step<0) ||  //negative loop sanity check, is it implemented?
 	    (startCondition ==endCondition && firstIteration) ) { // for expressions like for $n=1 to 1
 		if (!firstIteration)
-			(*currentVariableTable())[node->child(0)->token()->look()].setNumber(currentCount + step);
+			variable.setNumber(currentCount + step);
 		newScope = node->child(4); // (re-)execute the scope
 	} else {
 		// cleaning up after last iteration...
-		//delete functionStack.top().variableTable;
-		functionStack.pop();
-		// if we don't delete the functionStack's varibleTable any more
-		// do remove the for loops id..
-		currentVariableTable()->remove(id);
+		leaveLoop(node);
 	}
 EOS
 parse_item()
@@ -640,10 +642,9 @@ new_item()
 <<EOS
 	if (!checkParameterQuantity(node, 0, 20000+Token::Break*100+90)) return;
 
-	breaking = true;
-
 	// Check for the first parent which is a repeat, while of for loop.
-	// If found, switch the newScope to them so they can break.
+	// If found, go back to it so it can break, its expressions are
+	// not executed again.
 	QList<int> tokenTypes;
 	tokenTypes.append(Token::Repeat);
 	tokenTypes.append(Token::While);
@@ -651,8 +652,11 @@ new_item()
 
 	TreeNode* ns = getParentOfTokenTypes(node, &tokenTypes);
 
-	if(ns!=0)
-		newScope = ns;
+	if(ns!=0) {
+		breaking = true;
+		currentNode = ns;
+		executeCurrent = true;
+	}
 	//else
 		// We could add an error right HERE
 	
@@ -934,12 +938,10 @@ new_item()
 		return;
 	}
 	if (node->child(0)->value()->type() == Value::Number && node->child(1)->value()->type() == Value::Number) {
-		node->value()->setNumber(pow(node->child(0)->value()->number(), node->child(1)->value()->number()));
-		
+		errno = 0;
 		double result = pow(node->child(0)->value()->number(), node->child(1)->value()->number());
 
-		int error = errno;
-		if(error==ERANGE) {
+		if(errno==ERANGE) {
 			node->value()->setNumber(0);
 			addError(i18n("The result of an exponentiation was too large"), *node->token(), 0);
 		}else{
@@ -968,16 +970,8 @@ new_item()
 	addError(i18n("You need one variable and a value or variable to do a '='"), *node->token(), 0);
 		return;
 	}
-	if (!functionStack.isEmpty() && !globalVariableTable.contains(node->child(0)->token()->look())) // &&functionStack.top().variableTable->contains(node->token()->look())) 
-	{
-		// //qDebug() << "function scope";
-		functionStack.top().variableTable->insert(node->child(0)->token()->look(), node->child(1)->value());
-	} else {
-		// inserts unless already exists then replaces
-		globalVariableTable.insert(node->child(0)->token()->look(), node->child(1)->value());
-	}
-	// //qDebug() << "variableTable updated!";
-	emit variableTableUpdated(node->child(0)->token()->look(), node->child(1)->value());
+	// a local variable is only made in a function when there is no global one with that name
+	assignVariable(node->child(0), node->child(1)->value());
 EOS
 parse_item()
 
@@ -34,7 +34,13 @@
 #include <QtMath>
 
 
-void Executer::initialize(TreeNode* tree, ErrorList* _errorList)
+static const int LOOP_STACK_RESERVE = 64;  // nesting depth we allocate for up front
+static const int MEMO_TABLE_SIZE    = 4096;  // results remembered per pure function
+
+static const VariableSlot UNASSIGNED = { Value(), false };
+
+
+void Executer::initialize(TreeNode* tree, ErrorList* _errorList, const SlotLayout* _layout, const Program* _program)
 {
 	rootNode       = tree;
 	newScope       = rootNode;
@@ -45,20 +51,30 @@ void Executer::initialize(TreeNode* tree, ErrorList* _errorList)
 	breaking       = false;
 	returning      = false;
 	waiting        = false;
+	steps          = 0;
 	returnValue    = 0;
 	
 	executeCurrent = false;
 
 	functionTable.clear();
-	globalVariableTable.clear();
+	qDeleteAll(memoTables);
+	memoTables.clear();
+	functionsChecked = -1;
+	globalNames.clear();
+	if (m_memoizing)
+		collectGlobalNames(rootNode);
+	globalVariableTable.fill(UNASSIGNED, _layout->globalCount);
 
-	while (!functionStack.isEmpty()) {
-	    // In the ForTo loop, we can assign the globalVariableTable to an entry in the functionStack
-	    // we shouldn't delete this variableTable, so check for it.
-	    VariableTable* variableTable = functionStack.pop().variableTable;
-	    if(variableTable!=&globalVariableTable)
-		delete variableTable;
-	}
+	functionStack.resize(0);  // the frames stay in the framePool
+	callDepthExceeded = false;
+	specializing = true;
+
+	loopStack.resize(0);  // keeps the allocated capacity
+	loopStack.reserve(LOOP_STACK_RESERVE);
+
+	program        = _program;
+	programCounter = 0;
+	valueStack.resize(0);
 }
 
 
@@ -67,6 +83,14 @@ void Executer::execute()
 	//Do we have to do anything?
 	if (finished || waiting) return;
 
+	steps++;
+
+	if (program != 0) {
+		// executing bytecode, the tree is not walked at all
+		executeInstruction();
+		return;
+	}
+
 	if(executeCurrent) {
 		// executeCurrent is used to make sure the currentNode will be executed
 		// this way the tree will not be walked before the execution...
@@ -87,11 +111,11 @@ void Executer::execute()
 			return;
 		}
 
-		// Take the last called function from the function stack
+		// Take the last called function from the function stack, its frame is reused by the next call
 		CalledFunction calledFunction = functionStack.pop();
-		
-		// Delete the local variables of the called function
-		delete calledFunction.variableTable;
+
+		// Drop the state of the loops we are returning from
+		loopStack.resize(calledFunction.loopStackBase);
 		currentNode = calledFunction.function;
 
 		if (returnValue == 0)
@@ -99,6 +123,9 @@ void Executer::execute()
 		else
 			currentNode->setValue(returnValue);
 
+		if (calledFunction.memoTable != 0)
+			memoize(calledFunction, returnValue == 0 ? Value() : *returnValue);
+
 		execute(currentNode);
 		return;
 	}
@@ -158,6 +185,11 @@ void Executer::execute(TreeNode* node)
 
 	// if (currentNode->token()->type() != Token::Scope) //qDebug() << "1234567890!!!!!";
 
+	if (specializing && node->hasNumericOperands()) {
+		executeNumeric(node);
+		return;
+	}
+
 	switch (node->token()->type()) {
 
 //BEGIN GENERATED executer_switch_cpp CODE
@@ -254,14 +286,270 @@ void Executer::execute(TreeNode* node)
 }
 
 
-VariableTable* Executer::currentVariableTable()
+VariableSlot* Executer::readVariable(TreeNode* node)
 {
-	if (functionStack.isEmpty())
-		return &globalVariableTable;
+	if (!functionStack.isEmpty() && node->localSlot() >= 0) {
+		VariableSlot* local = &(*functionStack.top().variableTable)[node->localSlot()];
+		if (local->assigned) return local;
+	}
+	VariableSlot* global = &globalVariableTable[node->slot()];
+	return global->assigned ? global : 0;
+}
+
+VariableSlot* Executer::currentVariable(TreeNode* node)
+{
+	if (functionStack.isEmpty() || node->localSlot() < 0)
+		return &globalVariableTable[node->slot()];
 	else
-		return functionStack.top().variableTable;
+		return &(*functionStack.top().variableTable)[node->localSlot()];
+}
+
+TreeNode* Executer::linkFunction(TreeNode* node)
+{
+	if (node->link() == 0) {
+		// learned functions cannot be forgotten, so the first lookup holds for the rest of the run
+		FunctionTable::const_iterator function = functionTable.constFind(node->token()->look());
+		if (function == functionTable.constEnd()) return 0;
+		node->setLink(function.value());
+	}
+	return node->link();
+}
+
+void Executer::unlinkFunctions(TreeNode* tree)
+{
+	tree->setLink(0);
+	for (uint i = 0; i < tree->childCount(); i++)
+		unlinkFunctions(tree->child(i));
+}
+
+bool Executer::pushFrame(TreeNode* node, TreeNode* learnNode)
+{
+	int depth = functionStack.size();
+	if (maxCallDepth > 0 && depth >= maxCallDepth) {
+		addError(i18n("Cannot call the function '%1', more than %2 functions would be running within each other", node->token()->look(), maxCallDepth), *node->token(), 0);
+		callDepthExceeded = true;
+		finished = true;
+		return false;
+	}
+
+	if (depth == framePool.size())
+		framePool.append(new VariableTable());
+	VariableTable* frame = framePool.at(depth);
+	frame->fill(UNASSIGNED, learnNode->slot());  // keeps the allocated capacity
+
+	CalledFunction c;
+	c.function      = node;
+	c.variableTable = frame;
+	c.loopStackBase = loopStack.size();
+	c.returnAddress = programCounter;
+	c.memoTable     = 0;
+	c.errorCount    = errorList->size();
+	functionStack.push(c);
+	return true;
+}
+
+MemoTable* Executer::memoTable(TreeNode* learnNode)
+{
+	if (!m_memoizing) return 0;
+	// learning a function can make the functions that call it pure
+	if (functionTable.size() != functionsChecked)
+		findPureFunctions();
+	return memoTables.value(learnNode, 0);
+}
+
+void Executer::findPureFunctions()
+{
+	// all functions are assumed to be pure, until they do something else or call a function that does
+	QList<TreeNode*> functions = functionTable.values();
+	QHash<TreeNode*, bool> pure;
+	foreach (TreeNode* learnNode, functions)
+		pure.insert(learnNode, true);
+
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		foreach (TreeNode* learnNode, functions) {
+			if (!pure.value(learnNode) || isPureNode(learnNode->child(2), learnNode, pure)) continue;
+			pure.insert(learnNode, false);
+			changed = true;
+		}
+	}
+
+	foreach (TreeNode* learnNode, functions)
+		if (pure.value(learnNode) && !memoTables.contains(learnNode))
+			memoTables.insert(learnNode, new MemoTable());
+	functionsChecked = functionTable.size();
 }
 
+bool Executer::isPureNode(TreeNode* node, TreeNode* learnNode, const QHash<TreeNode*, bool>& pure)
+{
+	switch (node->token()->type()) {
+		case Token::Variable: {
+			// a function that reads or assigns a global variable depends on more than its arguments
+			const QString& name = node->token()->look();
+			if (!globalNames.contains(name)) break;
+			bool parameter = false;
+			for (uint i = 0; i < learnNode->child(1)->childCount(); i++)
+				if (learnNode->child(1)->child(i)->token()->look() == name) parameter = true;
+			// a parameter is read locally, but assigning it changes the global variable
+			bool assigned = node->parent()->token()->type() == Token::Assign && node->parent()->child(0) == node;
+			if (!parameter || assigned) return false;
+			break;
+		}
+
+		case Token::FunctionCall: {
+			TreeNode* called = functionTable.value(node->token()->look(), 0);
+			if (called == 0 || !pure.value(called, false)) return false;
+			break;
+		}
+
+		case Token::Scope:
+		case Token::String:
+		case Token::Number:
+		case Token::True:
+		case Token::False:
+		case Token::If:
+		case Token::Else:
+		case Token::Repeat:
+		case Token::While:
+		case Token::ForTo:
+		case Token::Break:
+		case Token::Return:
+		case Token::And:
+		case Token::Or:
+		case Token::Not:
+		case Token::Equals:
+		case Token::NotEquals:
+		case Token::GreaterThan:
+		case Token::LessThan:
+		case Token::GreaterOrEquals:
+		case Token::LessOrEquals:
+		case Token::Addition:
+		case Token::Substracton:
+		case Token::Multiplication:
+		case Token::Division:
+		case Token::Power:
+		case Token::Assign:
+		case Token::Pi:
+		case Token::Tan:
+		case Token::Sin:
+		case Token::Cos:
+		case Token::ArcTan:
+		case Token::ArcSin:
+		case Token::ArcCos:
+		case Token::Sqrt:
+		case Token::Round:
+		case Token::Mod:
+			break;
+
+		default:
+			// the turtle and canvas commands, print, message, ask, random, wait, exit...
+			return false;
+	}
+
+	for (uint i = 0; i < node->childCount(); i++)
+		if (!isPureNode(node->child(i), learnNode, pure)) return false;
+	return true;
+}
+
+void Executer::collectGlobalNames(TreeNode* node)
+{
+	// inside a function assigning only makes a global variable when it already exists
+	switch (node->token()->type()) {
+		case Token::Learn:
+			return;
+
+		case Token::Assign:
+		case Token::ForTo:
+			if (node->hasChildren())
+				globalNames.insert(node->child(0)->token()->look(), true);
+			break;
+
+		default:
+			break;
+	}
+
+	for (uint i = 0; i < node->childCount(); i++)
+		collectGlobalNames(node->child(i));
+}
+
+void Executer::appendMemoKey(QByteArray& key, const Value& value)
+{
+	key.append(static_cast<char>(value.type()));
+	switch (value.type()) {
+		case Value::Bool:
+			key.append(value.boolean() ? '1' : '0');
+			break;
+
+		case Value::Number: {
+			double number = value.number();
+			key.append(reinterpret_cast<const char*>(&number), sizeof(number));
+			break;
+		}
+
+		case Value::String: {
+			// the length first, so the arguments cannot run into each other
+			QString string = value.string();
+			int length = string.length();
+			key.append(reinterpret_cast<const char*>(&length), sizeof(length));
+			key.append(reinterpret_cast<const char*>(string.constData()), length * sizeof(QChar));
+			break;
+		}
+	}
+}
+
+void Executer::memoize(const CalledFunction& calledFunction, const Value& result)
+{
+	// a call that gave errors has to give them again the next time
+	if (errorList->size() != calledFunction.errorCount) return;
+
+	MemoTable* memo = calledFunction.memoTable;
+	if (memo->size() >= MEMO_TABLE_SIZE)
+		memo->clear();  // keeps the memory bounded, the latest arguments are the likely ones
+	memo->insert(calledFunction.memoKey, result);
+}
+
+void Executer::assignVariable(TreeNode* node, const Value& value)
+{
+	VariableSlot* variable = &globalVariableTable[node->slot()];
+	if (!variable->assigned && !functionStack.isEmpty() && node->localSlot() >= 0)
+		variable = &(*functionStack.top().variableTable)[node->localSlot()];
+	variable->value    = value;
+	variable->assigned = true;
+	emit variableTableUpdated(node->token()->look(), value);
+}
+
+
+
+
+LoopState* Executer::activeLoop(TreeNode* node)
+{
+	int base = functionStack.isEmpty() ? 0 : functionStack.top().loopStackBase;
+	if (loopStack.size() > base && loopStack.last().node == node)
+		return &loopStack.last();
+	return 0;
+}
+
+LoopState* Executer::enterLoop(TreeNode* node, double count)
+{
+	LoopState state;
+	state.node    = node;
+	state.count   = count;
+	state.entered = false;
+	loopStack.append(state);
+	return &loopStack.last();
+}
+
+void Executer::leaveLoop(TreeNode* node)
+{
+	// when breaking, the states of the ifs and loops nested in this loop are still on the stack
+	int base = functionStack.isEmpty() ? 0 : functionStack.top().loopStackBase;
+	while (loopStack.size() > base) {
+		TreeNode* popped = loopStack.last().node;
+		loopStack.removeLast();
+		if (popped == node) return;
+	}
+}
 
 
 
@@ -338,6 +626,256 @@ void Executer::addError(const QString& s, const Token& t, int code)
 }
 
 
+void Executer::executeInstruction()
+{
+	const Instruction& instruction = program->code.at(programCounter++);
+	TreeNode* node = instruction.node;
+
+	// the nodes are reported like the tree walker does, Execute and Evaluate do so in execute()
+	switch (instruction.opcode) {
+		case Compiler::Halt:
+			finished = true;
+			break;
+
+		case Compiler::Constant:
+			emit currentlyExecuting(node);
+			valueStack.append(*node->value());
+			break;
+
+		case Compiler::Empty:
+			valueStack.append(Value());
+			break;
+
+		case Compiler::Load: {
+			emit currentlyExecuting(node);
+			VariableSlot* variable = readVariable(node);
+			if (variable != 0) {
+				valueStack.append(variable->value);
+			} else {
+				addError(i18n("The variable '%1' was used without first being assigned to a value", node->token()->look()), *node->token(), 0);
+				valueStack.append(Value());
+				specializing = false;
+			}
+			break;
+		}
+
+		case Compiler::Assign:
+			emit currentlyExecuting(node);
+			assignVariable(node->child(0), valueStack.takeLast());
+			break;
+
+		case Compiler::Execute:
+			executeWithArguments(node, instruction.argument);
+			break;
+
+		case Compiler::Evaluate:
+			executeWithArguments(node, instruction.argument);
+			valueStack.append(*node->value());
+			break;
+
+		case Compiler::Call: {
+			int count = instruction.argument;
+			int first = valueStack.size() - count;
+			emit currentlyExecuting(node);
+			TreeNode* learnNode = linkFunction(node);
+			if (learnNode == 0) {
+				addError(i18n("An unknown function named '%1' was called", node->token()->look()), *node->token(), 0);
+				valueStack.resize(first);
+				valueStack.append(Value());
+				break;
+			}
+
+			if (static_cast<uint>(count) != learnNode->child(1)->childCount()) {
+				addError(
+					i18n("The function '%1' was called with %2, while it should be called with %3",
+						node->token()->look(),
+						i18ncp("The function '%1' was called with %2, while it should be called with %3", "1 parameter", "%1 parameters", count),
+						i18ncp("The function '%1' was called with %2, while it should be called with %3", "1 parameter", "%1 parameters", learnNode->child(1)->childCount())
+					),
+					*node->token(), 0);
+				valueStack.resize(first);
+				valueStack.append(Value());
+				break;
+			}
+
+			MemoTable* memo = memoTable(learnNode);
+			QByteArray key;
+			if (memo != 0) {
+				for (int i = 0; i < count; i++)
+					appendMemoKey(key, valueStack.at(first + i));
+				MemoTable::const_iterator result = memo->constFind(key);
+				if (result != memo->constEnd()) {
+					// called before with these arguments
+					valueStack.resize(first);
+					valueStack.append(result.value());
+					break;
+				}
+			}
+
+			if (!pushFrame(node, learnNode)) break;
+			functionStack.top().memoTable = memo;
+			functionStack.top().memoKey   = key;
+			VariableTable* frame = functionStack.top().variableTable;
+			for (int i = 0; i < count; i++) {
+				VariableSlot& argument = (*frame)[learnNode->child(1)->child(i)->localSlot()];
+				argument.value    = valueStack.at(first + i);
+				argument.assigned = true;
+			}
+			valueStack.resize(first);
+			programCounter = program->entries.value(learnNode);
+			break;
+		}
+
+		case Compiler::Return: {
+			emit currentlyExecuting(node);
+			if (functionStack.isEmpty()) {
+				addError(i18n("Cannot return outside a function. "), *node->token(), 0);
+				finished = true;
+				break;
+			}
+			int first = valueStack.size() - instruction.argument;
+			Value result = instruction.argument > 0 ? valueStack.at(first) : Value();
+			valueStack.resize(first);
+
+			CalledFunction calledFunction = functionStack.pop();
+			loopStack.resize(calledFunction.loopStackBase);
+			programCounter = calledFunction.returnAddress;
+			valueStack.append(result);
+			if (calledFunction.memoTable != 0)
+				memoize(calledFunction, result);
+			break;
+		}
+
+		case Compiler::Pop:
+			valueStack.removeLast();
+			break;
+
+		case Compiler::Jump:
+			programCounter = instruction.argument;
+			break;
+
+		case Compiler::JumpIfFalse:
+			emit currentlyExecuting(node);  // the if or while
+			if (!valueStack.takeLast().boolean())
+				programCounter = instruction.argument;
+			break;
+
+		case Compiler::RepeatEnter: {
+			emit currentlyExecuting(node);
+			double count = round(valueStack.takeLast().number());
+			if (static_cast<int>(count) <= 0)  // handle 'repeat 0'
+				programCounter = instruction.argument;
+			else
+				enterLoop(node, count);
+			break;
+		}
+
+		case Compiler::RepeatNext: {
+			emit currentlyExecuting(node);
+			LoopState& loop = loopStack.last();
+			if (loop.count > 0) {
+				loop.count--;
+			} else {
+				loopStack.removeLast();
+				programCounter = instruction.argument;
+			}
+			break;
+		}
+
+		case Compiler::ForEnter: {
+			// the start value is the first of the three values on top of the stack
+			VariableSlot* variable = currentVariable(node->child(0));
+			variable->value    = Value(valueStack.at(valueStack.size() - 3).number());
+			variable->assigned = true;
+			enterLoop(node);
+			break;
+		}
+
+		case Compiler::ForCheck: {
+			emit currentlyExecuting(node);
+			double step           = valueStack.takeLast().number();
+			double endCondition   = valueStack.takeLast().number();
+			double startCondition = valueStack.takeLast().number();
+
+			LoopState& loop = loopStack.last();
+			bool firstIteration = !loop.entered;
+			Value& variable = currentVariable(node->child(0))->value;
+			double currentCount = variable.number();
+
+			if ((startCondition < endCondition && currentCount + step <= endCondition) ||
+			    (startCondition > endCondition && currentCount + step >= endCondition && step<0) ||
+			    (startCondition ==endCondition && firstIteration) ) {
+				if (!firstIteration)
+					variable.setNumber(currentCount + step);
+				loop.entered = true;
+			} else {
+				loopStack.removeLast();
+				programCounter = instruction.argument;
+			}
+			break;
+		}
+
+		case Compiler::LeaveLoop:
+			loopStack.removeLast();
+			break;
+	}
+}
+
+
+void Executer::executeNumeric(TreeNode* node)
+{
+	// the TypeInferrer proved there are two operands that are numbers, so there is nothing to check
+	double x = node->child(0)->value()->number();
+	double y = node->child(1)->value()->number();
+
+	switch (node->token()->type()) {
+		case Token::Equals          : node->value()->setBool(x == y); break;
+		case Token::NotEquals       : node->value()->setBool(x != y); break;
+		case Token::GreaterThan     : node->value()->setBool(x >  y); break;
+		case Token::LessThan        : node->value()->setBool(x <  y); break;
+		case Token::GreaterOrEquals : node->value()->setBool(x >= y); break;
+		case Token::LessOrEquals    : node->value()->setBool(x <= y); break;
+		case Token::Addition        : node->value()->setNumber(x + y); break;
+		case Token::Substracton     : node->value()->setNumber(x - y); break;
+		case Token::Multiplication  : node->value()->setNumber(x * y); break;
+
+		case Token::Division:
+			if (y == 0) {
+				addError(i18n("You tried to divide by zero"), *node->token(), 0);
+				specializing = false;  // the node keeps its old value, which may not be a number
+				return;
+			}
+			node->value()->setNumber(x / y);
+			break;
+
+		case Token::Power: {
+			errno = 0;
+			double result = pow(x, y);
+			if (errno == ERANGE) {
+				node->value()->setNumber(0);
+				addError(i18n("The result of an exponentiation was too large"), *node->token(), 0);
+			} else {
+				node->value()->setNumber(result);
+			}
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+void Executer::executeWithArguments(TreeNode* node, int count)
+{
+	// the execute* methods expect the arguments as the values of the children
+	int first = valueStack.size() - count;
+	for (int i = 0; i < count; i++)
+		*node->child(i)->value() = valueStack.at(first + i);
+	valueStack.resize(first);
+	execute(node);
+}
+
+
 
 //BEGIN GENERATED executer_cpp CODE
 
@@ -371,6 +909,13 @@ void Executer::executeScope(TreeNode* node) {
 		returnValue = 0;
 		return;
 	}
+	// a scope of its own is executed once, like the scope of an if
+	if (activeLoop(node) != 0) {
+		// we are back from the scope
+		leaveLoop(node);
+		return;
+	}
+	enterLoop(node);
 	newScope = node;
 }
 void Executer::executeVariable(TreeNode* node) {
@@ -387,16 +932,14 @@ void Executer::executeVariable(TreeNode* node) {
 			aValueIsNeeded = false;
 		}
 	}
-	if (!functionStack.isEmpty() && 
-	    functionStack.top().variableTable->contains(node->token()->look())) {
-		// //qDebug() << "exists locally";
-		node->setValue( (*functionStack.top().variableTable)[node->token()->look()] );
-	} else if (globalVariableTable.contains(node->token()->look())) {
-		// //qDebug() << "exists globally";
-		node->setValue(globalVariableTable[node->token()->look()]);
+	// the local variable is found first, see readVariable()
+	VariableSlot* variable = readVariable(node);
+	if (variable != 0) {
+		node->setValue(variable->value);
 	} else if (aValueIsNeeded)
 	{
 		addError(i18n("The variable '%1' was used without first being assigned to a value", node->token()->look()), *node->token(), 0);
+		specializing = false;  // the node keeps its old value, see executeNumeric()
 	}
 }
 void Executer::executeFunctionCall(TreeNode* node) {
@@ -414,18 +957,11 @@ void Executer::executeFunctionCall(TreeNode* node) {
 		return;
 	}
 
-	if (!functionTable.contains(node->token()->look())) {
+	TreeNode* learnNode = linkFunction(node);
+	if (learnNode == 0) {
 		addError(i18n("An unknown function named '%1' was called", node->token()->look()), *node->token(), 0);
 		return;
 	}
-	
-	CalledFunction c;
-	c.function      = node;
-	c.variableTable = new VariableTable();
-	functionStack.push(c);
-	// //qDebug() << "==> functionCalled!";
-	
-	TreeNode* learnNode = functionTable[node->token()->look()];
 
 	// if the parameter numbers are not equal...
 	if (node->childCount() != learnNode->child(1)->childCount()) {
@@ -438,10 +974,33 @@ void Executer::executeFunctionCall(TreeNode* node) {
 			*node->token(), 0);
 		return;
 	}
-		
+
+	MemoTable* memo = memoTable(learnNode);
+	QByteArray key;
+	if (memo != 0) {
+		for (uint i = 0; i < node->childCount(); i++)
+			appendMemoKey(key, *node->child(i)->value());
+		MemoTable::const_iterator result = memo->constFind(key);
+		if (result != memo->constEnd()) {
+			// called before with these arguments
+			if (result.value().type() == Value::Empty)
+				node->setNullValue();
+			else
+				node->setValue(result.value());
+			return;
+		}
+	}
+
+	if (!pushFrame(node, learnNode)) return;
+	functionStack.top().memoTable = memo;
+	functionStack.top().memoKey   = key;
+	// //qDebug() << "==> functionCalled!";
+
+	VariableTable* frame = functionStack.top().variableTable;
 	for (uint i = 0; i < node->childCount(); i++) {
-		functionStack.top().variableTable->insert(learnNode->child(1)->child(i)->token()->look(), node->child(i)->value());
-		// //qDebug() << "inserted variable " << learnNode->child(1)->child(i)->token()->look() << " on function stack";
+		VariableSlot& argument = (*frame)[learnNode->child(1)->child(i)->localSlot()];
+		argument.value    = node->child(i)->value();
+		argument.assigned = true;
 	}
 	newScope = learnNode->child(2);
 }
@@ -452,19 +1011,19 @@ void Executer::executeExit(TreeNode* node) {
 }
 void Executer::executeIf(TreeNode* node) {
 //	//qDebug() << "called";
-	QString id = QString("__%1_%2").arg(node->token()->look()).arg(reinterpret_cast<quintptr>(node));
-	if (currentVariableTable()->contains(id)) {
-		currentVariableTable()->remove(id);
+	if (activeLoop(node) != 0) {
+		// we are back from the scope
+		leaveLoop(node);
 		return;
 	}
 	
 	if (node->child(0)->value()->boolean()) {
-		// store a empty Value just to know we executed once
-		currentVariableTable()->insert(id, Value());
+		// push a state just to know we executed once
+		enterLoop(node);
 		newScope = node->child(1);
 	} else {
 		if (node->childCount() >= 3) {
-			currentVariableTable()->insert(id, Value());
+			enterLoop(node);
 			newScope = node->child(2); // execute the else part
 		}
 	}
@@ -475,28 +1034,26 @@ void Executer::executeElse(TreeNode* node) {
 }
 void Executer::executeRepeat(TreeNode* node) {
 //	//qDebug() << "called";
-	QString id = QString("__%1_%2").arg(node->token()->look()).arg(reinterpret_cast<quintptr>(node));
-
 	if(breaking) {
 		breaking = false;
-		currentVariableTable()->remove(id);
+		leaveLoop(node);
 		return;
 	}
 
-	// the iteration state is stored on the variable table
-	if (currentVariableTable()->contains(id)) {
-		int currentCount = static_cast<int>(round((*currentVariableTable())[id].number()));
-		if (currentCount > 0) {
-			(*currentVariableTable())[id].setNumber(currentCount - 1);
+	// the iteration state is stored on the loop stack
+	LoopState* loop = activeLoop(node);
+	if (loop != 0) {
+		if (loop->count > 0) {
+			loop->count--;
 		} else {
-			currentVariableTable()->remove(id);
+			leaveLoop(node);
 			return;
 		}
 	} else {
 		if(static_cast<int>(round(node->child(0)->value()->number()))<=0) // handle 'repeat 0'
 			return;
 		
-		currentVariableTable()->insert(id, Value(round(node->child(0)->value()->number()) - 1.0));
+		enterLoop(node, round(node->child(0)->value()->number()) - 1.0);
 	}
 	newScope = node->child(1);
 }
@@ -507,26 +1064,24 @@ void Executer::executeWhile(TreeNode* node) {
 	// so we do the following on every call to executeWhile:
 	//     exec scope, exec expression, exec scope, exec expression, ...
 
-	QString id = QString("__%1_%2").arg(node->token()->look()).arg(reinterpret_cast<quintptr>(node));
-
 	if (breaking) {
 		// We hit a break command while executing the scope
 		breaking = false; // Not breaking anymore
-		currentVariableTable()->remove(id); // remove the value (cleanup)
+		leaveLoop(node); // pop the loop state (cleanup)
 		return; // Move to the next sibbling
 	}
 
-	if (currentVariableTable()->contains(id)) {
+	if (activeLoop(node) != 0) {
 		newScope = node; // re-execute the expression
-		currentVariableTable()->remove(id);
+		leaveLoop(node);
 		return;
 	}
-	currentVariableTable()->insert(id, Value()); // store a empty Value just to know we executed once
 
-	if (node->child(0)->value()->boolean())
+	if (node->child(0)->value()->boolean()) {
+		enterLoop(node); // push a state just to know we executed once
 		newScope = node->child(1); // (re-)execute the scope
-	else
-		currentVariableTable()->remove(id); // clean-up, keep currenNode on currentNode so the next sibling we be run next
+	}
+	// otherwise keep currenNode on currentNode so the next sibling we be run next
 }
 void Executer::executeFor(TreeNode* node) {
 //	//qDebug() << "called";
@@ -539,43 +1094,32 @@ void Executer::executeForTo(TreeNode* node) {
 	// after one iteration the expression is not re-executed.
 	// so we do: exec scope, exec expressions, exec scope, exec expressions, ...
 
-	//TODO: We have the cleanup part twice (after breaking and after the last iteration
-	// perhaps clean it up by putting in in one place?
+	if(breaking) {
+		breaking = false;
+		leaveLoop(node);
+		return;
+	}
 
 	bool firstIteration = false;
-	if (functionStack.isEmpty() || functionStack.top().function != node) {
+	LoopState* loop = activeLoop(node);
+	if (loop == 0) {
 		// if this for loop is called for the first time...
-		CalledFunction c;
-		c.function      = node;
-		// TODO: Find a better solution then this for nested for loops
-		//c.variableTable = new VariableTable();
-		c.variableTable = currentVariableTable();
-		functionStack.push(c);
-
-		currentVariableTable()->insert(node->child(0)->token()->look(), Value(node->child(1)->value()->number()));
+		loop = enterLoop(node);
+		VariableSlot* variable = currentVariable(node->child(0));
+		variable->value    = Value(node->child(1)->value()->number());
+		variable->assigned = true;
 		firstIteration = true;
 	}
 
-	QString id = QString("__%1_%2").arg(node->token()->look()).arg(reinterpret_cast<quintptr>(node));
-
-	if(breaking) {
-		breaking = false;
-		//delete functionStack.top().variableTable;
-		functionStack.pop();
-		// if we don't delete the functionStack's varibleTable any more
-		// do remove the for loops id..
-		currentVariableTable()->remove(id);
-		return;
-	}
-
-	if (currentVariableTable()->contains(id)) {
+	if (loop->entered) {
 		newScope = node; // re-execute the expressions
-		currentVariableTable()->remove(id);
+		loop->entered = false;
 		return;
 	}
-	currentVariableTable()->insert(id, Value()); // store a empty Value just to know we executed once
+	loop->entered = true; // just to know we executed once
 
-	double currentCount   = (*currentVariableTable())[node->child(0)->token()->look()].number();
+	Value& variable       = currentVariable(node->child(0))->value;
+	double currentCount   = variable.number();
 	double startCondition = node->child(1)->value()->number();
 	double endCondition   = node->child(2)->value()->number();
 	double step           = node->child(3)->value()->number();
@@ -584,25 +1128,20 @@ void Executer::executeForTo(TreeNode* node) {
 	    (startCondition > endCondition && currentCount + step >= endCondition && step<0) ||  //negative loop sanity check, is it implemented?
 	    (startCondition ==endCondition && firstIteration) ) { // for expressions like for $n=1 to 1
 		if (!firstIteration)
-			(*currentVariableTable())[node->child(0)->token()->look()].setNumber(currentCount + step);
+			variable.setNumber(currentCount + step);
 		newScope = node->child(4); // (re-)execute the scope
 	} else {
 		// cleaning up after last iteration...
-		//delete functionStack.top().variableTable;
-		functionStack.pop();
-		// if we don't delete the functionStack's varibleTable any more
-		// do remove the for loops id..
-		currentVariableTable()->remove(id);
+		leaveLoop(node);
 	}
 }
 void Executer::executeBreak(TreeNode* node) {
 //	//qDebug() << "called";
 	if (!checkParameterQuantity(node, 0, 20000+Token::Break*100+90)) return;
 
-	breaking = true;
-
 	// Check for the first parent which is a repeat, while of for loop.
-	// If found, switch the newScope to them so they can break.
+	// If found, go back to it so it can break, its expressions are
+	// not executed again.
 	QList<int> tokenTypes;
 	tokenTypes.append(Token::Repeat);
 	tokenTypes.append(Token::While);
@@ -610,8 +1149,11 @@ void Executer::executeBreak(TreeNode* node) {
 
 	TreeNode* ns = getParentOfTokenTypes(node, &tokenTypes);
 
-	if(ns!=0)
-		newScope = ns;
+	if(ns!=0) {
+		breaking = true;
+		currentNode = ns;
+		executeCurrent = true;
+	}
 	//else
 		// We could add an error right HERE
 	
@@ -783,12 +1325,10 @@ void Executer::executePower(TreeNode* node) {
 		return;
 	}
 	if (node->child(0)->value()->type() == Value::Number && node->child(1)->value()->type() == Value::Number) {
-		node->value()->setNumber(pow(node->child(0)->value()->number(), node->child(1)->value()->number()));
-		
+		errno = 0;
 		double result = pow(node->child(0)->value()->number(), node->child(1)->value()->number());
 
-		int error = errno;
-		if(error==ERANGE) {
+		if(errno==ERANGE) {
 			node->value()->setNumber(0);
 			addError(i18n("The result of an exponentiation was too large"), *node->token(), 0);
 		}else{
@@ -807,16 +1347,8 @@ void Executer::executeAssign(TreeNode* node) {
 	addError(i18n("You need one variable and a value or variable to do a '='"), *node->token(), 0);
 		return;
 	}
-	if (!functionStack.isEmpty() && !globalVariableTable.contains(node->child(0)->token()->look())) // &&functionStack.top().variableTable->contains(node->token()->look())) 
-	{
-		// //qDebug() << "function scope";
-		functionStack.top().variableTable->insert(node->child(0)->token()->look(), node->child(1)->value());
-	} else {
-		// inserts unless already exists then replaces
-		globalVariableTable.insert(node->child(0)->token()->look(), node->child(1)->value());
-	}
-	// //qDebug() << "variableTable updated!";
-	emit variableTableUpdated(node->child(0)->token()->look(), node->child(1)->value());
+	// a local variable is only made in a function when there is no global one with that name
+	assignVariable(node->child(0), node->child(1)->value());
 }
 void Executer::executeLearn(TreeNode* node) {
 //	//qDebug() << "called";
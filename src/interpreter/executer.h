@@ -20,12 +20,16 @@
 #ifndef _EXECUTER_H_
 #define _EXECUTER_H_
 
+#include <QByteArray>
 #include <QHash>
 #include <QObject>
 #include <QStack>
+#include <QVector>
 
 
+#include "compiler.h"
 #include "errormsg.h"
+#include "resolver.h"
 #include "token.h"
 #include "treenode.h"
 
@@ -33,13 +37,29 @@
 
 // some typedefs and a struct for the template classes used:
 
-typedef QHash<QString, Value>     VariableTable;
+typedef struct {
+	Value          value;
+	bool           assigned;      // FALSE until the variable is assigned a value
+} VariableSlot;
+typedef QVector<VariableSlot>     VariableTable;
 typedef QHash<QString, TreeNode*> FunctionTable;
+typedef QHash<QByteArray, Value>  MemoTable;      // results of a pure function by its argument values
 typedef struct {
 	TreeNode*      function;      // pointer to the node of the function caller
-	VariableTable* variableTable; // pointer to the variable table of the function
+	VariableTable* variableTable; // pointer to the local variable slots of the function
+	int            loopStackBase; // size of the loopStack when the function was called
+	int            returnAddress; // instruction to continue with after returning (bytecode only)
+	MemoTable*     memoTable;     // where the result goes when the function is pure, otherwise zero
+	QByteArray     memoKey;       // the argument values of a pure function
+	int            errorCount;    // size of the errorList when the function was called
 } CalledFunction;
 typedef QStack<CalledFunction>    FunctionStack;
+typedef struct {
+	TreeNode*      node;          // pointer to the if, repeat, while or for node
+	double         count;         // iterations left (repeat only)
+	bool           entered;       // TRUE while executing the scope (for only)
+} LoopState;
+typedef QVector<LoopState>        LoopStack;
 
 
 
@@ -53,6 +73,15 @@ typedef QStack<CalledFunction>    FunctionStack;
  * and a functionTable that contains pointer to the 'learned' functions.
  * When running into a function a local variable table and a pointer to the
  * functionCallNode are put onto the functionStack.
+ * The variable tables are arrays of slots, the Variable nodes know their slots
+ * (see Resolver) so variables are not looked up by name.
+ * The state of the if statements and loops that are being executed is kept
+ * on the loopStack.
+ * The results of pure functions are remembered by their arguments, see
+ * setMemoizing().
+ *
+ * Instead of walking the node tree the Executer can also execute a Program
+ * as compiled from the tree by the Compiler, see initialize().
  *
  * Executer inherits from QObject for the SIGNALS/SLOTS mechanism.
  * Signals are emitted for all external things the Executer has to trigger (like
@@ -71,11 +100,11 @@ class Executer : public QObject
 		 * @short Constructor. Initialses the Executer.
 		 * does nothing special. @see initialize().
 		 */
-		explicit Executer(bool testing = false) : m_testing(testing) {}
+		explicit Executer(bool testing = false) : maxCallDepth(0), program(0), m_testing(testing), m_memoizing(true) {}
 		/**
-		 * @short Destructor. Does nothing at special.
+		 * @short Destructor. Deletes the frames of the framePool and the memoTables.
 		 */
-		virtual ~Executer() {}
+		virtual ~Executer() { qDeleteAll(framePool); qDeleteAll(memoTables); }
 
 
 		/**
@@ -84,14 +113,26 @@ class Executer : public QObject
 		 *                  by the Parser
 		 * @param errorList pointer to a QList for ErrorMessage objects, when
 		 *                  error occur they will be stored here
+		 * @param layout    pointer to the SlotLayout of the tree as provided
+		 *                  by the Resolver
+		 * @param program   pointer to the Program compiled from the tree, when
+		 *                  given it is executed instead of the tree
+		 */
+		void initialize(TreeNode* tree, ErrorList* _errorList, const SlotLayout* _layout, const Program* _program = 0);
+
+		/**
+		 * @short Forgets the learned functions the FunctionCall nodes of @p tree are linked to.
+		 * Needed before the same tree is executed again, as a function is only
+		 * known once its learn command has been executed.
 		 */
-		void initialize(TreeNode* tree, ErrorList* _errorList);
+		void           unlinkFunctions(TreeNode* tree);
 
 		/**
 		 * @short Executes one 'step' (usually a TreeNode).
 		 * This methods scans over the node tree to find the next TreeNode to
 		 * execute, and executes it. It starts by the leafs, and works it way to
-		 * the root. @see isFinished
+		 * the root. When executing a Program one step is one Instruction.
+		 * @see isFinished
 		 */
 		void           execute();
 
@@ -101,9 +142,39 @@ class Executer : public QObject
 		 */
 		bool           isFinished() const { return finished; }
 
+		/**
+		 * @short Reflects if the Executer is waiting (as instructed by the 'wait' command).
+		 * @return TRUE when waiting, otherwise FALSE.
+		 */
+		bool           isWaiting() const { return waiting; }
+
+		/** @returns the amount of execute() steps (nodes or instructions) done since initialize() */
+		quint64        stepCount() const { return steps; }
+
+		/** @returns the amount of learned functions that are being executed (nested) */
+		int            callDepth() const { return functionStack.size(); }
+
+		/**
+		 * @short Sets the maximum amount of nested function calls, zero means unlimited.
+		 * Exceeding it adds an error and finishes the execution.
+		 */
+		void           setMaxCallDepth(int depth) { maxCallDepth = depth; }
+
+		/** @returns TRUE when the execution finished because the maximum call depth was exceeded */
+		bool           exceededCallDepth() const { return callDepthExceeded; }
+
+		/**
+		 * @short Sets whether the results of pure learned functions are remembered (the default).
+		 * A function is pure when it does not draw, print, ask, wait, use random
+		 * numbers or global variables, and only calls pure functions. Calling it
+		 * again with the same arguments gives the stored result without
+		 * executing it. Takes effect on the next initialize().
+		 */
+		void           setMemoizing(bool memoizing) { m_memoizing = memoizing; }
+
 
-	private slots:
-		/// Used by the singleshot wait timer.
+	public slots:
+		/// Used by the singleshot wait timer, and by the Interpreter to cut a wait short.
 		void stopWaiting() { waiting = false; }
 
 
@@ -111,6 +182,15 @@ class Executer : public QObject
 		/// Executes a single TreeNode, mainly a switch to the individual executer* functions.
 		void           execute(TreeNode* node);
 
+		/// Executes an arithmetic or comparison node of which both operands are numbers. @see TreeNode::hasNumericOperands()
+		void           executeNumeric(TreeNode* node);
+
+		/// Executes the next Instruction of the program.
+		void           executeInstruction();
+
+		/// Pops @p count values of the valueStack and executes @p node with them as the values of its children.
+		void           executeWithArguments(TreeNode* node, int count);
+
 		/// Adds an error to the error list.
 		void           addError(const QString& s, const Token& t, int code);
 
@@ -120,20 +200,93 @@ class Executer : public QObject
 		/// Checks the types of @p n 's parameters match the type @p valueType, if not it adds an error with @p errorCode
 		bool           checkParameterType(TreeNode* n, int valueType, int errorCode);
 
-		/// @returns the variable table of the current function, or the globalVariableTable if not running in a function
-		VariableTable* currentVariableTable();
+		/// @returns the variable @p node reads: the local one if it was assigned, else the global one if it was assigned, otherwise zero
+		VariableSlot*  readVariable(TreeNode* node);
+
+		/// @returns the variable of @p node in the current function, or the global one if not running in a function
+		VariableSlot*  currentVariable(TreeNode* node);
+
+		/// @returns the Learn node of the function @p node calls, linking it on the first call (zero for unknown functions)
+		TreeNode*      linkFunction(TreeNode* node);
+
+		/// Pushes a frame for calling @p learnNode from @p node onto the functionStack, @returns FALSE when exceeding the maximum call depth
+		bool           pushFrame(TreeNode* node, TreeNode* learnNode);
+
+		/// Assigns @p value to the global variable of @p node if it exists or when not running in a function, otherwise to the local one
+		void           assignVariable(TreeNode* node, const Value& value);
+
+		/// @returns the MemoTable of @p learnNode when it is a pure function and memoizing is on, otherwise zero
+		MemoTable*     memoTable(TreeNode* learnNode);
+
+		/// Adds a MemoTable to the memoTables for each pure function of the functionTable
+		void           findPureFunctions();
+
+		/// @returns TRUE when @p node, part of the body of @p learnNode, only computes and calls the @p pure functions
+		bool           isPureNode(TreeNode* node, TreeNode* learnNode, const QHash<TreeNode*, bool>& pure);
+
+		/// Adds the names of the variables that are assigned outside of learned functions in @p node to the globalNames
+		void           collectGlobalNames(TreeNode* node);
+
+		/// Appends @p value to the @p key of a MemoTable
+		static void    appendMemoKey(QByteArray& key, const Value& value);
+
+		/// Stores @p result in the MemoTable of @p calledFunction, unless the call gave errors
+		void           memoize(const CalledFunction& calledFunction, const Value& result);
+
+		/// @returns the state of @p node if it is the innermost loop entered in the current function, otherwise zero
+		LoopState*     activeLoop(TreeNode* node);
+
+		/// Pushes a new state for @p node with @p count iterations left on the loopStack, and returns it
+		LoopState*     enterLoop(TreeNode* node, double count = 0);
+
+		/// Pops the states from the loopStack up to and including the one of @p node
+		void           leaveLoop(TreeNode* node);
 
 
 
 		/// QHash containing pointers to the 'learned' functions
 		FunctionTable       functionTable;
 
-		/// QHash containing the global variables
+		/// The slots of the global variables
 		VariableTable       globalVariableTable;
 
+
 		/// Stores both pointers to functionNodes and accompanying local variable table using the predefined struct.
 		FunctionStack       functionStack;
 
+		/// The local variable tables of all call depths reached so far, reused by the next calls at that depth
+		QVector<VariableTable*> framePool;
+
+		/// The results of the pure functions, the functions without an entry are not pure
+		QHash<TreeNode*, MemoTable*> memoTables;
+
+		/// The size of the functionTable when findPureFunctions() was last called (-1 when not called yet)
+		int                 functionsChecked;
+
+		/// The names of the variables that are assigned outside of learned functions, so are global
+		QHash<QString, bool> globalNames;
+
+		/// The maximum size of the functionStack, zero means unlimited
+		int                 maxCallDepth;
+
+		/// TRUE when a call was refused because of the maxCallDepth
+		bool                callDepthExceeded;
+
+		/// FALSE after an error left a value that was proven to be numeric without a number, from then on executeNumeric() is not used
+		bool                specializing;
+
+		/// Stores the state of the if statements and loops that are being executed, innermost on top.
+		LoopStack           loopStack;
+
+		/// Pointer to the program when executing bytecode, otherwise zero
+		const Program      *program;
+
+		/// The address of the next instruction of the program
+		int                 programCounter;
+
+		/// Holds the intermediate values while executing bytecode
+		QVector<Value>      valueStack;
+
 		/// Pointer to the error list as supplied to the constructor
 		ErrorList          *errorList;
 
@@ -157,6 +310,9 @@ class Executer : public QObject
 		/// TRUE when execution is waiting
 		bool           waiting;
 
+		/// The amount of execute() steps done since initialize()
+		quint64        steps;
+
 		/// TRUE when breaking from a loop
 		bool           breaking;
 
@@ -167,6 +323,7 @@ class Executer : public QObject
 		bool           executeCurrent;
 
 		bool           m_testing;
+		bool           m_memoizing;
 
 
 
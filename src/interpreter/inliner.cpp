@@ -0,0 +1,184 @@
+/*
+	Copyright (C) 2026 agent <agent AT local>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public
+	License as published by the Free Software Foundation; either
+	version 2 of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to the Free
+	Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+	Boston, MA 02110-1301, USA.
+*/
+
+#include "inliner.h"
+
+
+
+void Inliner::inlineCalls(TreeNode* rootNode)
+{
+	functions.clear();
+
+	// a function can only be called after its learn was executed, so the
+	// statements only see the functions learned before them
+	QList<TreeNode*> children;
+	bool changed = false;
+	for (uint i = 0; i < rootNode->childCount(); i++) {
+		TreeNode* node = rootNode->child(i);
+		if (node->token()->type() != Token::Learn) {
+			changed |= inlineChild(rootNode, i, children);
+			continue;
+		}
+
+		inlineChildren(node);
+		if (node->childCount() >= 3) {
+			// when learned twice the first one is used (the second gives an error)
+			const QString& name = node->child(0)->token()->look();
+			if (!functions.contains(name))
+				functions.insert(name, isInlinable(node) ? node : 0);
+		}
+		children.append(node);
+	}
+	if (changed) rootNode->setChildren(children);
+}
+
+
+void Inliner::inlineChildren(TreeNode* node)
+{
+	// the new children are collected first, inserting them one by one would renumber the rest every time
+	QList<TreeNode*> children;
+	bool changed = false;
+	for (uint i = 0; i < node->childCount(); i++)
+		changed |= inlineChild(node, i, children);
+	if (changed) node->setChildren(children);
+}
+
+
+bool Inliner::inlineChild(TreeNode* parent, int index, QList<TreeNode*>& result)
+{
+	TreeNode* node = parent->child(index);
+	inlineChildren(node);  // the arguments first
+	result.append(node);  // replaced below when the call is inlined
+
+	if (node->token()->type() != Token::FunctionCall || parent->token()->type() == Token::Learn) return false;
+	TreeNode* learnNode = functions.value(node->token()->look(), 0);
+	if (learnNode == 0) return false;
+
+	TreeNode* parameters = learnNode->child(1);
+	if (node->childCount() != parameters->childCount()) return false;  // the executer reports that
+
+	TreeNode* body = learnNode->child(2);
+	for (uint i = 0; i < node->childCount(); i++) {
+		// an argument is evaluated once, before the body is executed
+		int type = node->child(i)->token()->type();
+		bool literal = type == Token::Number || type == Token::String || type == Token::True || type == Token::False;
+		if (!literal && (type != Token::Variable || parameterUses(body, learnNode, i) != 1)) return false;
+	}
+
+	int parentType = parent->token()->type();
+	bool statement = parentType == Token::Scope || parentType == Token::Root;
+	bool returns = body->childCount() == 1 && body->child(0)->token()->type() == Token::Return;
+
+	if (returns) {
+		if (statement) return false;
+		result.last() = copy(body->child(0)->child(0), learnNode, node);
+		return true;
+	}
+
+	if (!statement) return false;
+	result.removeLast();
+	for (uint i = 0; i < body->childCount(); i++)
+		result.append(copy(body->child(i), learnNode, node));
+	return true;
+}
+
+
+bool Inliner::isInlinable(TreeNode* learnNode)
+{
+	TreeNode* body = learnNode->child(2);
+	if (body->token()->type() != Token::Scope || size(body) > MAX_INLINE_SIZE) return false;
+
+	if (body->childCount() == 1 && body->child(0)->token()->type() == Token::Return) {
+		// a function that only returns a value
+		TreeNode* returnNode = body->child(0);
+		return returnNode->childCount() == 1 && isInlinableNode(returnNode->child(0), learnNode);
+	}
+
+	for (uint i = 0; i < body->childCount(); i++)
+		if (!isInlinableNode(body->child(i), learnNode)) return false;
+	return true;
+}
+
+
+bool Inliner::isInlinableNode(TreeNode* node, TreeNode* learnNode)
+{
+	switch (node->token()->type()) {
+		case Token::Variable:
+			if (parameterIndex(node, learnNode) < 0) return false;
+			break;
+
+		case Token::FunctionCall:
+		case Token::Learn:
+		case Token::Return:
+		case Token::Break:
+		case Token::Assign:
+		case Token::For:
+		case Token::ForTo:
+			return false;
+
+		default:
+			break;
+	}
+
+	for (uint i = 0; i < node->childCount(); i++)
+		if (!isInlinableNode(node->child(i), learnNode)) return false;
+	return true;
+}
+
+
+int Inliner::parameterIndex(TreeNode* node, TreeNode* learnNode)
+{
+	TreeNode* parameters = learnNode->child(1);
+	for (uint i = 0; i < parameters->childCount(); i++)
+		if (parameters->child(i)->token()->look() == node->token()->look()) return i;
+	return -1;
+}
+
+
+int Inliner::parameterUses(TreeNode* node, TreeNode* learnNode, int index)
+{
+	int uses = 0;
+	if (node->token()->type() == Token::Variable && parameterIndex(node, learnNode) == index) uses++;
+	for (uint i = 0; i < node->childCount(); i++)
+		uses += parameterUses(node->child(i), learnNode, index);
+	return uses;
+}
+
+
+int Inliner::size(TreeNode* node)
+{
+	int count = 1;
+	for (uint i = 0; i < node->childCount(); i++)
+		count += size(node->child(i));
+	return count;
+}
+
+
+TreeNode* Inliner::copy(TreeNode* node, TreeNode* learnNode, TreeNode* callNode)
+{
+	// the body only uses its parameters, the arguments are copied as they are
+	if (learnNode != 0 && node->token()->type() == Token::Variable)
+		return copy(callNode->child(parameterIndex(node, learnNode)), 0, 0);
+
+	TreeNode* result = new TreeNode(node->token());
+	if (node->hasValue()) result->setValue(*node->value());  // the value of literals
+	for (uint i = 0; i < node->childCount(); i++)
+		result->appendChild(copy(node->child(i), learnNode, callNode));
+	return result;
+}
@@ -0,0 +1,102 @@
+/*
+	Copyright (C) 2026 agent <agent AT local>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public
+	License as published by the Free Software Foundation; either
+	version 2 of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to the Free
+	Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+	Boston, MA 02110-1301, USA.
+*/
+
+#ifndef _INLINER_H_
+#define _INLINER_H_
+
+#include <QHash>
+#include <QString>
+
+#include "treenode.h"
+
+
+
+/**
+ * @short Expands calls to small learned functions at their call sites.
+ *
+ * The Inliner walks the node tree, as yielded by the Parser, once before it
+ * is executed. A call to a learned function is replaced by a copy of the body
+ * of that function when that can be done without changing what the program
+ * does:
+ *  - the learn is a statement of the main program and comes before the call,
+ *  - the body has at most MAX_INLINE_SIZE nodes, and does not call functions,
+ *    assign variables, break, or use variables other than its parameters
+ *    (so it is not recursive and it does not matter which variable table
+ *    it would run with),
+ *  - the body has no return and the call is a statement, or the body only
+ *    returns an expression and the call is used as a value,
+ *  - every argument is a literal, or a variable that is used once in the body.
+ *
+ * The copies share the Tokens of the body, so errors are reported at the
+ * same place as when the function is called. Calls that do not qualify are
+ * left as they are.
+ */
+class Inliner
+{
+	public:
+		/**
+		 * @short Constructor. Does nothing special.
+		 */
+		Inliner() {}
+
+		/**
+		 * @short Destructor. Does nothing special.
+		 */
+		~Inliner() {}
+
+		/**
+		 * @short Inlines the calls of the tree starting at @p rootNode in place.
+		 */
+		void         inlineCalls(TreeNode* rootNode);
+
+
+	private:
+		/// Inlines the calls in the children of @p node
+		void         inlineChildren(TreeNode* node);
+
+		/// Appends child number @p index of @p parent to @p result, or the nodes that take its place when it is a call that qualifies, @returns TRUE when it was inlined
+		bool         inlineChild(TreeNode* parent, int index, QList<TreeNode*>& result);
+
+		/// @returns TRUE when the body of @p learnNode can be copied to its call sites
+		bool         isInlinable(TreeNode* learnNode);
+
+		/// @returns TRUE when @p node and its children can be part of an inlined body of @p learnNode
+		bool         isInlinableNode(TreeNode* node, TreeNode* learnNode);
+
+		/// @returns the parameter number of the Variable @p node in @p learnNode (-1 when it is not a parameter)
+		int          parameterIndex(TreeNode* node, TreeNode* learnNode);
+
+		/// @returns the amount of Variable nodes in @p node and its children that are parameter number @p index of @p learnNode
+		int          parameterUses(TreeNode* node, TreeNode* learnNode, int index);
+
+		/// @returns the amount of nodes in @p node and its children
+		int          size(TreeNode* node);
+
+		/// @returns a copy of @p node in which the parameters of @p learnNode are replaced by the arguments of @p callNode (a plain copy when @p learnNode is zero)
+		TreeNode*    copy(TreeNode* node, TreeNode* learnNode, TreeNode* callNode);
+
+		/// The maximum amount of nodes of an inlined body
+		static const int MAX_INLINE_SIZE = 32;
+
+		/// The learned functions that can be inlined, by name
+		QHash<QString, TreeNode*>  functions;
+};
+
+
+#endif  // _INLINER_H_
@@ -22,18 +22,45 @@
 
 #include <QtDebug>
 
+#include <QCryptographicHash>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QDebug>
+#include <QThread>
 
+#include "arena.h"
+#include "compiler.h"
 #include "errormsg.h"
 #include "executer.h"
+#include "inliner.h"
+#include "optimizer.h"
 #include "parser.h"
+#include "resolver.h"
 #include "tokenizer.h"
 #include "translator.h"
+#include "typeinferrer.h"
+
+
+const int Interpreter::DEFAULT_MAX_CALL_DEPTH;
+static const int PROGRESS_STATEMENTS    = 1000;   // statements parsed in the background between progress reports
+
+
+/// The worker thread of Interpreter::ParseInBackground
+class ParseThread : public QThread
+{
+	public:
+		explicit ParseThread(Interpreter* interpreter) : QThread(interpreter), interpreter(interpreter) {}
+
+	protected:
+		void run() override { interpreter->parseInBackground(); }
+
+	private:
+		Interpreter* interpreter;
+};
 
 
 Interpreter::Interpreter(QObject* parent, bool testing)
-	: QObject(parent), m_testing(testing)
+	: QObject(parent), m_exceededLimit(NoLimit), m_segments(0), m_testing(testing), m_compiling(false), m_optimizing(true), m_inlining(false), m_caching(true), m_parseMode(ParseAll)
 {
 	if (testing) {
 		new InterpreterAdaptor(this);
@@ -42,27 +69,85 @@ Interpreter::Interpreter(QObject* parent, bool testing)
 	}
 
 	errorList  = new ErrorList();
+	arena      = new Arena();
 	tokenizer  = new Tokenizer();
 	parser     = new Parser(testing);
 	executer   = new Executer(testing);
+	inliner    = new Inliner();
+	optimizer  = new Optimizer();
+	resolver   = new Resolver();
+	typeInferrer = new TypeInferrer();
+	layout     = 0;
+	compiler   = new Compiler();
+	program    = 0;
+	cachedTree = 0;
+	m_preparing = false;
+	m_startedParses = 0;
+	m_finishedParses = 0;
+	parseThread = new ParseThread(this);
+	connect(parseThread, &QThread::finished, this, &Interpreter::parsedInBackground);
+
+	m_limits.steps     = 0;
+	m_limits.msecs     = 0;
+	m_limits.callDepth = DEFAULT_MAX_CALL_DEPTH;
+	m_limits.segments  = 0;
+	executer->setMaxCallDepth(m_limits.callDepth);
+	m_penIsDown = true;
+	connect(executer, &Executer::forward, this, &Interpreter::countSegment);
+	connect(executer, &Executer::backward, this, &Interpreter::countSegment);
+	connect(executer, &Executer::penUp, this, &Interpreter::setPenUp);
+	connect(executer, &Executer::penDown, this, &Interpreter::setPenDown);
+	connect(executer, &Executer::reset, this, &Interpreter::setPenDown);  // like the canvas does
+	m_deadline = new QTimer(this);
+	m_deadline->setSingleShot(true);
+	connect(m_deadline, &QTimer::timeout, this, &Interpreter::timeLimitReached);
 
     m_state = Uninitialized;
 }
 
 Interpreter::~Interpreter()
 {
+    stopParsing();
     errorList->clear();
     delete errorList;
     delete tokenizer;
     delete parser;
     delete executer;
+    delete inliner;
+    delete optimizer;
+    delete resolver;
+    delete typeInferrer;
+    delete layout;
+    delete compiler;
+    delete program;
+    delete arena;
 }
 
 void Interpreter::initialize(const QString& inString)
 {
+	stopParsing();  // the worker thread uses the arena and the error list
 	errorList->clear();
-	tokenizer->initialize(inString);
+	m_exceededLimit = NoLimit;
+	m_segments = 0;
+	m_penIsDown = true;
+	m_timer.start();
+	if (m_limits.msecs > 0)
+		m_deadline->start(m_limits.msecs);
+	else
+		m_deadline->stop();
 	m_state = Initialized;
+
+	m_runKey = m_caching ? cacheKey(inString) : QByteArray();
+	if (isCached()) return;  // the tree, layout and program of the previous run are used again
+
+	m_cacheKey.clear();
+	cachedTree = 0;
+	tokenizer->initialize(inString);
+	delete program;
+	program = 0;
+	delete layout;
+	layout = 0;
+	arena->release();  // the node tree of the previous run
 }
 
 void Interpreter::interpret()
@@ -73,16 +158,39 @@ void Interpreter::interpret()
 			return;
 
 
-		case Initialized:
+		case Initialized: {
+			if (isCached()) {
+				emit parsing();
+				executer->unlinkFunctions(cachedTree);
+				startExecuting(cachedTree);
+				return;
+			}
+
+			Arena::Activator activator(arena);
 			parser->initialize(tokenizer, errorList);
 			m_state = Parsing;
 // 			//qDebug() << "Initialized the parser, parsing the code...";
 			emit parsing();
+			if (m_parseMode == ParseInBackground)
+				startParsing();  // continues in parsedInBackground()
 			break;
+		}
+
 
+		case Parsing: {
+			if (parseThread->isRunning()) return;
 
-		case Parsing:
-			parser->parse();
+			Arena::Activator activator(arena);
+			if (m_parseMode == ParseStatements)
+				parser->parse();
+			else if (m_parseMode == ParseAll)
+				parser->parseAll();
+
+			if (m_limits.msecs > 0 && m_timer.hasExpired(m_limits.msecs)) {
+				m_exceededLimit = TimeLimit;
+				m_state = Aborted;
+				return;
+			}
 
 			if (encounteredErrors()) {
 				m_state = Aborted;
@@ -97,22 +205,22 @@ void Interpreter::interpret()
 			if (parser->isFinished()) {
 // 				//qDebug() << "Finished parsing.\n";
 				TreeNode* tree = parser->getRootNode();
-				emit treeUpdated(tree);
 // 				//qDebug() << "Node tree as returned by parser:";
 // 				parser->printTree();
 // 				//qDebug() << "";
-
-				executer->initialize(tree, errorList);
-				m_state = Executing;
-// 				//qDebug() << "Initialized the executer, executing the node tree...";
-				emit executing();
+				finishTree(tree);
+				m_cacheKey = m_runKey;
+				startExecuting(tree);
 				return;
 			}
 			break;
+		}
 
 
 		case Executing:
 			executer->execute();
+			checkLimits();
+			if (m_state == Aborted) return;
 
 			if (executer->isFinished()) {
 // 				//qDebug() << "Finished executing.\n";
@@ -136,3 +244,168 @@ void Interpreter::interpret()
 			return;
 	}
 }
+
+void Interpreter::finishTree(TreeNode* tree)
+{
+	if (m_inlining)
+		inliner->inlineCalls(tree);  // before optimizing, so the literal arguments are folded
+	if (m_optimizing) {
+		optimizer->optimize(tree);  // still in the arena, the folded literals are allocated there too
+		typeInferrer->infer(tree);
+	}
+	delete layout;
+	layout = resolver->resolve(tree);
+	if (m_compiling) {
+		delete program;
+		program = compiler->compile(tree);
+	}
+	// keep all of it for running the same code again, see setCaching()
+	cachedTree = tree;
+}
+
+void Interpreter::startExecuting(TreeNode* tree)
+{
+	emit treeUpdated(tree);
+	executer->initialize(tree, errorList, layout, program);
+	m_state = Executing;
+// 	//qDebug() << "Initialized the executer, executing the node tree...";
+	emit executing();
+}
+
+QByteArray Interpreter::cacheKey(const QString& code) const
+{
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	hash.addData(reinterpret_cast<const char*>(code.constData()), code.length() * sizeof(QChar));
+	hash.addData(Translator::instance()->language().toUtf8());  // the same code is parsed differently in another language
+	// the passes that change the tree, or compile it
+	const char passes[] = { m_inlining, m_optimizing, m_compiling };
+	hash.addData(passes, sizeof(passes));
+	return hash.result();
+}
+
+void Interpreter::prepare(const QString& code)
+{
+	if (!m_caching || m_state == Initialized || m_state == Parsing || m_state == Executing) return;
+	QByteArray key = cacheKey(code);
+	if (key == m_cacheKey || (m_preparing && key == m_preparedKey)) return;  // parsed already, or being parsed
+
+	stopParsing();
+	emit treeUpdated(0);  // the tree of the previous run is released
+	m_cacheKey.clear();
+	cachedTree = 0;
+	delete program;
+	program = 0;
+	delete layout;
+	layout = 0;
+	arena->release();
+
+	tokenizer->initialize(code);
+	preparedErrors.clear();
+	Arena::Activator activator(arena);
+	parser->initialize(tokenizer, &preparedErrors);
+	m_preparedKey = key;
+	m_preparing = true;
+	startParsing();  // continues in parsedInBackground()
+}
+
+void Interpreter::abort()
+{
+	stopParsing();
+	m_state = Aborted;
+}
+
+bool Interpreter::isParsingInBackground() const
+{
+	return parseThread->isRunning();
+}
+
+void Interpreter::parseInBackground()
+{
+	// the Tokens and TreeNodes made on this thread go into the arena too, see Arena::Activator
+	Arena::Activator activator(arena);
+	qint64 length = qMax(1, tokenizer->length());
+	while (!parser->isFinished() && !parser->encounteredErrors() && !parseThread->isInterruptionRequested()) {
+		parser->parseAll(PROGRESS_STATEMENTS);
+		if (!m_preparing)  // nobody waits for that
+			emit parseProgress(static_cast<int>(100 * parser->parsedLength() / length));
+	}
+}
+
+void Interpreter::startParsing()
+{
+	m_startedParses++;
+	parseThread->start();
+}
+
+void Interpreter::parsedInBackground()
+{
+	if (++m_finishedParses < m_startedParses) return;  // an interrupted run, the thread runs again already
+	parseThread->wait();  // finished() is emitted just before the thread is done
+	if (m_preparing) {
+		m_preparing = false;
+		if (parser->isFinished() && !parser->encounteredErrors()) {
+			Arena::Activator activator(arena);
+			finishTree(parser->getRootNode());
+			m_cacheKey = m_preparedKey;
+		}
+		return;
+	}
+	if (m_state == Parsing)
+		emit parsed();
+}
+
+void Interpreter::stopParsing()
+{
+	if (parseThread->isRunning()) {
+		parseThread->requestInterruption();
+		parseThread->wait();
+	}
+	m_preparing = false;  // after the thread is done, it reads the flag
+}
+
+void Interpreter::checkLimits()
+{
+	if (m_limits.steps > 0 && executer->stepCount() > m_limits.steps)
+		m_exceededLimit = StepLimit;
+	else if (executer->exceededCallDepth())  // the executer refuses the call itself, see Executer::setMaxCallDepth()
+		m_exceededLimit = CallDepthLimit;
+	else if (m_limits.segments > 0 && m_segments > m_limits.segments)
+		m_exceededLimit = SegmentLimit;
+	else if (m_limits.msecs > 0 && (executer->stepCount() & 0xff) == 0 && m_timer.hasExpired(m_limits.msecs))
+		m_exceededLimit = TimeLimit;  // only looked at once every 256 steps, reading the clock is not free
+	else
+		return;
+	m_state = Aborted;
+}
+
+void Interpreter::timeLimitReached()
+{
+	if (m_state != Parsing && m_state != Executing) return;  // finished in time
+	stopParsing();
+	executer->stopWaiting();
+	m_exceededLimit = TimeLimit;
+	m_state = Aborted;
+}
+
+QString Interpreter::exceededLimitString() const
+{
+	switch (m_exceededLimit) {
+		case StepLimit:      return QString("the step limit of %1 steps").arg(m_limits.steps);
+		case TimeLimit:      return QString("the time limit of %1 msecs").arg(m_limits.msecs);
+		case CallDepthLimit: return QString("the call depth limit of %1 nested calls").arg(m_limits.callDepth);
+		case SegmentLimit:   return QString("the segment limit of %1 drawn lines").arg(m_limits.segments);
+	}
+	return QString();
+}
+
+void Interpreter::interpretFor(int msecs)
+{
+	QElapsedTimer timer;
+	timer.start();
+	do {
+		interpret();
+	} while ((m_state == Parsing || m_state == Executing) &&
+	         !executer->isWaiting() &&
+	         !isParsingInBackground() &&
+	         !timer.hasExpired(msecs));
+}
@@ -21,15 +21,26 @@
 #ifndef _INTERPRETER_H_
 #define _INTERPRETER_H_
 
+#include <QElapsedTimer>
 #include <QStringList>
 #include <QTextStream>
+#include <QTimer>
 
+#include "arena.h"
+#include "compiler.h"
 #include "errormsg.h"
 #include "executer.h"
+#include "inliner.h"
+#include "optimizer.h"
 #include "parser.h"
+#include "resolver.h"
 #include "tokenizer.h"
 #include "translator.h"
 #include "treenode.h"
+#include "typeinferrer.h"
+
+
+class QThread;
 
 
 /**
@@ -66,7 +77,121 @@ class Interpreter : public QObject
 			Aborted        // unsuccessfully finished
 		};
 
-		void        abort() { m_state = Aborted; }
+		/// The call depth limit when none is set, fails cleanly long before memory runs out
+		static const int DEFAULT_MAX_CALL_DEPTH = 10000;
+
+		/// The resource limits a run can exceed, see setLimits()
+		enum Limit {
+			NoLimit,
+			StepLimit,      // executed steps (nodes, or instructions when compiling)
+			TimeLimit,      // wall clock time, parsing included
+			CallDepthLimit, // nested calls of learned functions
+			SegmentLimit    // lines drawn by forward and backward, with the pen down
+		};
+
+		/// Resource limits for a run, zero means unlimited
+		typedef struct {
+			quint64 steps;
+			int     msecs;
+			int     callDepth;
+			quint64 segments;
+		} Limits;
+
+		/// How the code is parsed, see setParseMode()
+		enum ParseMode {
+			ParseStatements,   // one statement per interpret() call
+			ParseAll,          // all statements in one interpret() call
+			ParseInBackground  // all statements on a worker thread
+		};
+
+		/// Aborts the run, waits for the worker thread when parsing in the background
+		void        abort();
+
+		/**
+		 * Sets how the code is parsed, by default it is parsed all at once
+		 * (ParseAll). ParseStatements parses one statement per interpret()
+		 * call, like it used to. With ParseInBackground the first interpret()
+		 * call of the Parsing state starts a worker thread, and interpret()
+		 * does nothing until parsed() is emitted. parseProgress() is emitted
+		 * while the worker thread runs.
+		 */
+		void        setParseMode(int mode) { m_parseMode = mode; }
+
+		/// @returns TRUE while the code is parsed on the worker thread, see setParseMode()
+		bool        isParsingInBackground() const;
+		/**
+		 * Interrupts the worker thread and waits for it to finish, when it
+		 * runs. A run that is Parsing does not go on after that, abort() it.
+		 */
+		void        stopParsing();
+
+		/**
+		 * Keeps calling interpret() until @p msecs milliseconds have passed,
+		 * the interpreter is no longer Parsing or Executing, the executer is
+		 * waiting, or the code is parsed in the background. Used to run many
+		 * steps per event-loop iteration.
+		 */
+		void        interpretFor(int msecs);
+
+		/**
+		 * When @p compiling is true the parse tree is compiled to bytecode
+		 * (see Compiler) before it is executed, instead of being walked.
+		 */
+		void        setCompiling(bool compiling) { m_compiling = compiling; }
+
+		/**
+		 * When @p optimizing is true (the default) constant expressions are
+		 * folded and dead branches are dropped from the parse tree (see
+		 * Optimizer) before it is executed, and the arithmetic of which the
+		 * operands are always numbers is executed without checks (see
+		 * TypeInferrer).
+		 */
+		void        setOptimizing(bool optimizing) { m_optimizing = optimizing; }
+
+		/**
+		 * When @p inlining is true the calls to small learned functions are
+		 * replaced by the bodies of those functions (see Inliner) before the
+		 * parse tree is optimized. This is off by default.
+		 */
+		void        setInlining(bool inlining) { m_inlining = inlining; }
+
+		/**
+		 * When @p memoizing is true (the default) the results of pure learned
+		 * functions are remembered by their arguments, see
+		 * Executer::setMemoizing().
+		 */
+		void        setMemoizing(bool memoizing) { executer->setMemoizing(memoizing); }
+		/**
+		 * When @p caching is true (the default) the parse tree, with the
+		 * output of the passes that follow parsing, is kept after a run. When
+		 * initialize() is called with the same code, the same language and
+		 * the same passes, it is executed again without being parsed.
+		 */
+		void        setCaching(bool caching) { m_caching = caching; }
+		/// @returns TRUE when the code given to initialize() runs on the tree kept from before
+		bool        isCached() const { return !m_cacheKey.isEmpty() && m_cacheKey == m_runKey; }
+
+		/**
+		 * Parses @p code on the worker thread ahead of a run, when no run is
+		 * going on. The tree is kept as if it was run, so when initialize() is
+		 * called with the same code the run starts on it (see setCaching()).
+		 * Errors are not reported, the run that parses the code again does.
+		 */
+		void        prepare(const QString& code);
+
+		/**
+		 * Sets the resource limits, by default there are none except for the
+		 * call depth. When a limit is exceeded the interpreter is Aborted and
+		 * exceededLimit() tells which one.
+		 */
+		void        setLimits(const Limits& limits) { m_limits = limits; executer->setMaxCallDepth(limits.callDepth); }
+		const Limits& limits() const { return m_limits; }
+
+		/// @returns the Limit that aborted the last run, NoLimit if none did
+		int         exceededLimit() const { return m_exceededLimit; }
+
+		/// @returns a description of the exceeded limit, like "the time limit of 1000 msecs"
+		QString     exceededLimitString() const;
 
 		Executer*   getExecuter() { return executer; }
 		ErrorList*  getErrorList() { return errorList; }
@@ -85,17 +210,81 @@ class Interpreter : public QObject
 		
 		void treeUpdated(TreeNode* rootNode);
 
+		/// Emitted when parsing in the background is done, interpret() continues from there
+		void parsed();
+
+		/// Emitted while parsing in the background, with the @p percent of the code that is parsed
+		void parseProgress(int percent);
+
+	private slots:
+		void        countSegment() { if (m_penIsDown) m_segments++; }
+		void        setPenUp() { m_penIsDown = false; }
+		void        setPenDown() { m_penIsDown = true; }
+
+		/// Aborts the run when the time limit is reached, also while the executer waits or parsing runs in the background
+		void        timeLimitReached();
+
+		/// Called when the worker thread is done, see setParseMode()
+		void        parsedInBackground();
+
 	private:
+		friend class ParseThread;
+
+		/// Aborts the run when a limit is exceeded, called after each execution step
+		void           checkLimits();
+
+		/// Parses the code in parts, emitting parseProgress() in between, run by the worker thread
+		void           parseInBackground();
+
+		/// Starts the worker thread, see parseInBackground()
+		void           startParsing();
+		/// Runs the passes that follow parsing on @p tree and keeps it, see setCaching()
+		void           finishTree(TreeNode* tree);
+		/// Hands the parsed (or cached) @p tree to the executer and starts Executing
+		void           startExecuting(TreeNode* tree);
+		/// @returns the hash of @p code, the language and the passes that are run, see setCaching()
+		QByteArray     cacheKey(const QString& code) const;
+
 		int            m_state;
 
+		Limits         m_limits;
+		int            m_exceededLimit;
+		quint64        m_segments;
+		QElapsedTimer  m_timer;
+		QTimer        *m_deadline;  // fires when the time limit is reached, it wakes up the event loop of a 'wait'
+		bool           m_penIsDown;
+
 		Translator    *translator;
+		Arena         *arena;  // owns the Tokens and TreeNodes of the current run
 		Tokenizer     *tokenizer;
 		Parser        *parser;
 		Executer      *executer;
+		Inliner       *inliner;
+		Optimizer     *optimizer;
+		Resolver      *resolver;
+		TypeInferrer  *typeInferrer;
+		Compiler      *compiler;
+		QThread       *parseThread;
+
+		SlotLayout    *layout;
+		Program       *program;
+		TreeNode      *cachedTree;  // the tree in the arena that m_cacheKey belongs to
+		QByteArray     m_cacheKey;
+		QByteArray     m_runKey;    // the cache key of the code given to initialize()
+		QByteArray     m_preparedKey;  // the cache key of the code given to prepare()
+		bool           m_preparing;    // TRUE while the worker thread parses for prepare()
+		ErrorList      preparedErrors;  // the errors found by prepare(), not shown
+		int            m_startedParses;   // counts the worker thread runs,
+		int            m_finishedParses;  // so a late finished() of an interrupted one is told apart
 
 		ErrorList     *errorList;
 
 		bool           m_testing;
+		bool           m_compiling;
+		bool           m_optimizing;
+		bool           m_inlining;
+		bool           m_caching;
+		int            m_parseMode;
 };
 
 #endif  // _INTERPRETER_H_
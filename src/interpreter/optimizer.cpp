@@ -0,0 +1,253 @@
+/*
+	Copyright (C) 2026 agent <agent AT local>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public
+	License as published by the Free Software Foundation; either
+	version 2 of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to the Free
+	Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+	Boston, MA 02110-1301, USA.
+*/
+
+#include "optimizer.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+
+#include <cmath>  // for std::isfinite
+
+#include <QtMath>
+
+
+
+void Optimizer::optimize(TreeNode* rootNode)
+{
+	optimizeChildren(rootNode);
+}
+
+
+void Optimizer::optimizeChildren(TreeNode* node)
+{
+	// the new children are collected first, inserting them one by one would renumber the rest every time
+	QList<TreeNode*> children;
+	bool changed = false;
+	for (uint i = 0; i < node->childCount(); i++)
+		changed |= optimizeChild(node, i, children);
+	if (changed) node->setChildren(children);
+}
+
+
+bool Optimizer::optimizeChild(TreeNode* parent, int index, QList<TreeNode*>& result)
+{
+	TreeNode* node = parent->child(index);
+	optimizeChildren(node);  // the operands first, so nested expressions fold all the way up
+
+	switch (node->token()->type()) {
+		case Token::If:
+		case Token::While:
+			return pruneBranch(parent, index, result);
+
+		default: {
+			Value value;
+			if (fold(node, value)) {
+				result.append(literal(node, value));
+				return true;
+			}
+			result.append(node);
+			return false;
+		}
+	}
+}
+
+
+bool Optimizer::pruneBranch(TreeNode* parent, int index, QList<TreeNode*>& result)
+{
+	TreeNode* node = parent->child(index);
+	result.append(node);  // replaced below when the branch is known
+	if (node->childCount() < 2 || !isLiteral(node->child(0))) return false;
+
+	// an if can be a statement of a scope or the else part of another if
+	int parentType = parent->token()->type();
+	bool elsePart = parentType == Token::If && index == 2;
+	if (!elsePart && parentType != Token::Scope && parentType != Token::Root) return false;
+
+	TreeNode* taken = 0;
+	if (node->child(0)->value()->boolean()) {
+		if (node->token()->type() == Token::While) return false;  // endless, or left by a break
+		taken = node->child(1);
+	} else if (node->token()->type() == Token::If && node->childCount() >= 3) {
+		taken = node->child(2);
+	}
+
+	result.removeLast();
+	if (taken == 0) return true;
+
+	if (taken->token()->type() == Token::Scope && !elsePart) {
+		// the statements of the scope take the place of the if, scopes do not hold variables
+		for (uint i = 0; i < taken->childCount(); i++)
+			result.append(taken->child(i));
+		return true;
+	}
+
+	result.append(taken);
+	return true;
+}
+
+
+bool Optimizer::fold(TreeNode* node, Value& result)
+{
+	for (uint i = 0; i < node->childCount(); i++)
+		if (!isLiteral(node->child(i))) return false;
+
+	// this mirrors the Executer, but leaves everything that gives an error to it
+	uint count = node->childCount();
+	switch (node->token()->type()) {
+		case Token::Addition:
+		case Token::Substracton:
+		case Token::Multiplication:
+		case Token::Division:
+		case Token::Power: {
+			// adding strings is left to the executer, the result would not be a literal token
+			if (count != 2 || !isNumber(node->child(0)) || !isNumber(node->child(1))) return false;
+			double a = node->child(0)->value()->number();
+			double b = node->child(1)->value()->number();
+			switch (node->token()->type()) {
+				case Token::Addition:       result.setNumber(a + b); break;
+				case Token::Substracton:    result.setNumber(a - b); break;
+				case Token::Multiplication: result.setNumber(a * b); break;
+				case Token::Division:
+					if (b == 0) return false;
+					result.setNumber(a / b);
+					break;
+				case Token::Power: {
+					// the same test as Executer::executePower(), overflow and underflow are left to it
+					errno = 0;
+					double power = pow(a, b);
+					if (errno == ERANGE || !std::isfinite(power)) return false;
+					result.setNumber(power);
+					break;
+				}
+			}
+			return true;
+		}
+
+		case Token::Equals:
+		case Token::NotEquals:
+		case Token::GreaterThan:
+		case Token::LessThan:
+		case Token::GreaterOrEquals:
+		case Token::LessOrEquals: {
+			if (count != 2) return false;
+			Value* a = node->child(0)->value();
+			Value* b = node->child(1)->value();
+			switch (node->token()->type()) {
+				case Token::Equals:          result.setBool(*a == b); break;
+				case Token::NotEquals:       result.setBool(*a != b); break;
+				case Token::GreaterThan:     result.setBool(*a >  b); break;
+				case Token::LessThan:        result.setBool(*a <  b); break;
+				case Token::GreaterOrEquals: result.setBool(*a >= b); break;
+				case Token::LessOrEquals:    result.setBool(*a <= b); break;
+			}
+			return true;
+		}
+
+		case Token::And:
+			if (count != 2) return false;
+			result.setBool(node->child(0)->value()->boolean() && node->child(1)->value()->boolean());
+			return true;
+
+		case Token::Or:
+			if (count != 2) return false;
+			result.setBool(node->child(0)->value()->boolean() || node->child(1)->value()->boolean());
+			return true;
+
+		case Token::Not:
+			if (count != 1) return false;
+			result.setBool(!node->child(0)->value()->boolean());
+			return true;
+
+		case Token::Pi:
+			if (count != 0) return false;
+			result.setNumber(M_PI);
+			return true;
+
+		case Token::Tan:
+		case Token::Sin:
+		case Token::Cos:
+		case Token::ArcTan:
+		case Token::ArcSin:
+		case Token::ArcCos:
+		case Token::Sqrt:
+		case Token::Round: {
+			if (count != 1) return false;
+			double x = node->child(0)->value()->number();
+			switch (node->token()->type()) {
+				case Token::Tan:    result.setNumber(tan(qDegreesToRadians(x)));  break;
+				case Token::Sin:    result.setNumber(sin(qDegreesToRadians(x)));  break;
+				case Token::Cos:    result.setNumber(cos(qDegreesToRadians(x)));  break;
+				case Token::ArcTan: result.setNumber(qRadiansToDegrees(atan(x))); break;
+				case Token::ArcSin: result.setNumber(qRadiansToDegrees(asin(x))); break;
+				case Token::ArcCos: result.setNumber(qRadiansToDegrees(acos(x))); break;
+				case Token::Round:  result.setNumber(round(x));                   break;
+				case Token::Sqrt:
+					if (x < 0) return false;
+					result.setNumber(sqrt(x));
+					break;
+			}
+			return true;
+		}
+
+		case Token::Mod: {
+			if (count != 2 || !isNumber(node->child(0)) || !isNumber(node->child(1))) return false;
+			double x = round(node->child(0)->value()->number());
+			double y = round(node->child(1)->value()->number());
+			if (y == 0 || fabs(x) > INT_MAX || fabs(y) > INT_MAX) return false;
+			result.setNumber(static_cast<double>(static_cast<int>(x) % static_cast<int>(y)));
+			return true;
+		}
+
+		default:
+			return false;  // commands, variables, function calls, random, ...
+	}
+}
+
+
+bool Optimizer::isLiteral(TreeNode* node)
+{
+	switch (node->token()->type()) {
+		case Token::Number:
+		case Token::String:
+		case Token::True:
+		case Token::False:
+			return !node->hasChildren();
+	}
+	return false;
+}
+
+
+bool Optimizer::isNumber(TreeNode* node)
+{
+	return isLiteral(node) && node->value()->type() == Value::Number;
+}
+
+
+TreeNode* Optimizer::literal(TreeNode* node, const Value& value)
+{
+	int type = Token::Number;
+	if (value.type() == Value::Bool)
+		type = value.boolean() ? Token::True : Token::False;
+
+	Token* t = node->token();
+	TreeNode* literalNode = new TreeNode(new Token(type, value.string(), t->startRow(), t->startCol(), t->endRow(), t->endCol()));
+	literalNode->setValue(value);
+	return literalNode;
+}
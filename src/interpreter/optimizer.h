@@ -0,0 +1,85 @@
+/*
+	Copyright (C) 2026 agent <agent AT local>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public
+	License as published by the Free Software Foundation; either
+	version 2 of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to the Free
+	Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+	Boston, MA 02110-1301, USA.
+*/
+
+#ifndef _OPTIMIZER_H_
+#define _OPTIMIZER_H_
+
+#include "treenode.h"
+
+
+
+/**
+ * @short Folds constant expressions and drops dead branches of a node tree.
+ *
+ * The Optimizer walks the node tree, as yielded by the Parser, once before it
+ * is executed. Expressions of which all operands are literals, like '10 * 3 + 2'
+ * or 'sqrt 2', are replaced by a single literal. Ifs and whiles with a literal
+ * condition are replaced by the branch that would be taken, or removed.
+ *
+ * Only what can be evaluated without errors is folded (so 'x / 0' is left to
+ * the Executer), and the folded literals take the position of the node they
+ * replace, so errors are still reported at the same place.
+ *
+ * Replaced nodes are not deleted, they are left to the Arena that holds the
+ * node tree.
+ */
+class Optimizer
+{
+	public:
+		/**
+		 * @short Constructor. Does nothing special.
+		 */
+		Optimizer() {}
+
+		/**
+		 * @short Destructor. Does nothing special.
+		 */
+		~Optimizer() {}
+
+		/**
+		 * @short Optimizes the node tree starting at @p rootNode in place.
+		 */
+		void         optimize(TreeNode* rootNode);
+
+
+	private:
+		/// Optimizes all children of @p node
+		void         optimizeChildren(TreeNode* node);
+
+		/// Optimizes child number @p index of @p parent and appends it, or the nodes that take its place, to @p result; @returns TRUE when it was replaced
+		bool         optimizeChild(TreeNode* parent, int index, QList<TreeNode*>& result);
+
+		/// Appends the taken branch of the if or while at @p index of @p parent to @p result (or the node itself when not known), @returns TRUE when it was replaced
+		bool         pruneBranch(TreeNode* parent, int index, QList<TreeNode*>& result);
+
+		/// Evaluates @p node of which all children are literals, @returns FALSE when it cannot be folded
+		bool         fold(TreeNode* node, Value& result);
+
+		/// @returns TRUE when @p node is a Number, String, True or False literal
+		bool         isLiteral(TreeNode* node);
+
+		/// @returns TRUE when @p node is a literal with a number value
+		bool         isNumber(TreeNode* node);
+
+		/// @returns a new literal node with @p value, at the position of @p node
+		TreeNode*    literal(TreeNode* node, const Value& value);
+};
+
+
+#endif  // _OPTIMIZER_H_
@@ -65,6 +65,16 @@ void Parser::parse()
 	}
 }
 
+void Parser::parseAll(int maxStatements)
+{
+	int errorCount = errorList->size();
+	int statements = 0;
+	while (!finished && errorList->size() == errorCount) {
+		parse();
+		if (++statements == maxStatements) return;
+	}
+}
+
 void Parser::nextToken()
 {
 	// get the next relevant token, and store it in currentToken
@@ -74,12 +74,32 @@ class Parser
 		 */
 		void         parse();
 
+		/**
+		 * @short Parses all statements, until the end of the input or an error.
+		 * Unlike parse() this builds the whole node tree in one call. When
+		 * @p maxStatements is not zero it stops after that many statements,
+		 * so the node tree can be built in parts. @see parsedLength
+		 */
+		void         parseAll(int maxStatements = 0);
+
+		/** @returns the amount of characters of the code that are parsed so far */
+		int          parsedLength() const { return tokenizer->position(); }
+
+		/** @returns TRUE when the statements parsed so far left no scope open */
+		bool         isAtRootScope() const { return currentScope == rootNode; }
+
+		/** @returns the row of the token the next statement starts with */
+		int          nextRow() const { return currentToken->startRow(); }
+
 		/**
 		 * @short Reflects if the Parser has finished parsing (got an EndOfInput token).
 		 * @return TRUE when parsing has finished otherwise FALSE.
 		 */
 		bool         isFinished() const { return finished; }
 
+		/** @returns TRUE when errors were added to the ErrorList given to initialize() */
+		bool         encounteredErrors() const { return !errorList->isEmpty(); }
+
 		/**
 		 * @short Method to get the root node of the node tree (pointer based data structure).
 		 * The Parser does not delete the node tree so this pointer can be passed
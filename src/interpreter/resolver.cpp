@@ -0,0 +1,77 @@
+/*
+	Copyright (C) 2026 agent <agent AT local>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public
+	License as published by the Free Software Foundation; either
+	version 2 of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to the Free
+	Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+	Boston, MA 02110-1301, USA.
+*/
+
+#include "resolver.h"
+
+
+
+SlotLayout* Resolver::resolve(TreeNode* rootNode)
+{
+	layout = new SlotLayout;
+	layout->globalCount = 0;
+	globalSlots.clear();
+	localSlots.clear();
+
+	resolve(rootNode, 0);
+
+	return layout;
+}
+
+
+void Resolver::resolve(TreeNode* node, TreeNode* learnNode)
+{
+	switch (node->token()->type()) {
+		case Token::Variable: {
+			const QString& name = node->token()->look();
+			QHash<QString, int>::const_iterator global = globalSlots.constFind(name);
+			if (global == globalSlots.constEnd())
+				global = globalSlots.insert(name, layout->globalCount++);
+
+			int localSlot = -1;
+			if (learnNode != 0) {
+				QHash<QString, int>::const_iterator local = localSlots.constFind(name);
+				if (local == localSlots.constEnd())
+					local = localSlots.insert(name, localSlots.size());
+				localSlot = local.value();
+			}
+			node->setSlots(global.value(), localSlot);
+			break;
+		}
+
+		case Token::Learn: {
+			// the argument list and the body get their own local slots, the
+			// arguments first so they take the lowest slots in argument order
+			QHash<QString, int> outerSlots;
+			outerSlots.swap(localSlots);
+
+			for (uint i = 0; i < node->childCount(); i++)
+				resolve(node->child(i), node);
+			node->setSlots(localSlots.size(), -1);
+
+			localSlots.swap(outerSlots);
+			return;
+		}
+
+		default:
+			break;
+	}
+
+	for (uint i = 0; i < node->childCount(); i++)
+		resolve(node->child(i), learnNode);
+}
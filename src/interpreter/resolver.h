@@ -0,0 +1,88 @@
+/*
+	Copyright (C) 2026 agent <agent AT local>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public
+	License as published by the Free Software Foundation; either
+	version 2 of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to the Free
+	Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+	Boston, MA 02110-1301, USA.
+*/
+
+#ifndef _RESOLVER_H_
+#define _RESOLVER_H_
+
+#include <QHash>
+#include <QString>
+
+#include "treenode.h"
+
+
+
+// a typedef for the result of the resolution:
+
+typedef struct {
+	int                   globalCount; // amount of global variable slots
+} SlotLayout;
+
+
+
+/**
+ * @short Resolves the variables of a node tree to numbered slots.
+ *
+ * The Resolver walks the node tree, as yielded by the Parser, once and gives
+ * each Variable node the number of the slot that holds its value, so the
+ * Executer can use arrays of values instead of looking variables up by name.
+ *
+ * Every variable name gets a global slot. The Variable nodes in the body (or
+ * the argument list) of a learned function also get a local slot in the frame
+ * of that function. Which of the two is used is still decided while executing,
+ * exactly like it was when variables were looked up by name: a local variable
+ * is only read when it was assigned, and assigning in a function only creates
+ * a local variable when there is no global variable with that name.
+ *
+ * The slot of a Learn node is the amount of local slots its frame needs.
+ */
+class Resolver
+{
+	public:
+		/**
+		 * @short Constructor. Does nothing special.
+		 */
+		Resolver() {}
+
+		/**
+		 * @short Destructor. Does nothing special.
+		 */
+		~Resolver() {}
+
+		/**
+		 * @short Sets the slots of all Variable nodes of the tree starting at @p rootNode.
+		 * @returns a newly allocated SlotLayout, owned by the caller
+		 */
+		SlotLayout* resolve(TreeNode* rootNode);
+
+
+	private:
+		/// Resolves @p node and its children, @p learnNode is the function they are in (zero if none)
+		void        resolve(TreeNode* node, TreeNode* learnNode);
+
+		SlotLayout                *layout;
+
+		/// The global slot of each variable name
+		QHash<QString, int>        globalSlots;
+
+		/// The local slot of each variable name of the function that is being resolved
+		QHash<QString, int>        localSlots;
+};
+
+
+#endif  // _RESOLVER_H_
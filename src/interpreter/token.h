@@ -23,6 +23,8 @@
 
 #include <QString>
 
+#include "arena.h"
+
 
 /**
  * @short The Token object, represents a piece of TurtleScript as found by the Tokenizer.
@@ -219,6 +221,10 @@ class Token
 
 		virtual ~Token() {}
 
+		/// Tokens are placed in the active Arena, if there is one
+		static void* operator new(size_t size) { return Arena::allocateToken(size); }
+		static void  operator delete(void* p)  { Arena::deallocate(p); }
+
 
 		const QString& look()
 		               const { return _look; }
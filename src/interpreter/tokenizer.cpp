@@ -21,6 +21,22 @@
 
 #include <QDebug>
 
+
+// classification of the ASCII characters, so QChar's unicode tables are only used for the others
+enum { WordCharacter = 1, DigitCharacter = 2, SpaceCharacter = 4 };
+
+static struct AsciiClasses {
+	AsciiClasses() {
+		for (int i = 0; i < ASCII_TABLE_SIZE; i++) {
+			flags[i] = 0;
+			if ((i >= 'a' && i <= 'z') || (i >= 'A' && i <= 'Z')) flags[i] |= WordCharacter;
+			if (i >= '0' && i <= '9')                             flags[i] |= DigitCharacter;
+			if (i == ' ' || i == '\t')                            flags[i] |= SpaceCharacter;
+		}
+	}
+	unsigned char flags[ASCII_TABLE_SIZE];
+} asciiClasses;
+
 void Tokenizer::initialize(const QString& inString)
 {
 	translator  = Translator::instance();
@@ -35,116 +51,159 @@ void Tokenizer::initialize(const QString& inString)
 
 Token* Tokenizer::getToken()
 {
-	int startRow = row;
-	int startCol = col;
+	TokenView view;
+	scan(view);
+	return toToken(view);
+}
+
+
+Token* Tokenizer::toToken(const TokenView& view) const
+{
+	return new Token(view.type, look(view), view.startRow, view.startCol, view.endRow, view.endCol);
+}
+
+
+QString Tokenizer::look(const TokenView& view) const
+{
+	switch (view.type) {
+		case Token::EndOfInput: return "END";
+		case Token::EndOfLine:  return "\\n";
+
+		case Token::WhiteSpace: {
+			QString look;
+			for (int i = view.start; i < view.start + view.length; i++)
+				look += (isTab(inputString.at(i)) ? "  " : " ");
+			return look;
+		}
+
+		default:
+			return inputString.mid(view.start, view.length);
+	}
+}
+
+
+bool Tokenizer::scan(TokenView& view)
+{
+	view.start    = at;
+	view.startRow = row;
+	view.startCol = col;
 
 	QChar c = getChar();  // get and store the next character from the string
 
 	// catch the end of the input string
-	if (atEnd)
-		return new Token(Token::EndOfInput, "END", row, col, row, col);
+	if (atEnd) {
+		finishView(view, Token::EndOfInput);
+		return false;
+	}
 
 	int cType = translator->look2type(c);  // since we need to know it often we store it
 
 	// catch spaces
 	if (isSpace(c)) {
-		QString look;
 		do {
-			look += (isTab(c) ? "  " : " ");
 			c = getChar();
 		} while (isSpace(c) && !atEnd);
 		ungetChar();
-		return new Token(Token::WhiteSpace, look, startRow, startCol, row, col);
+		finishView(view, Token::WhiteSpace);
+		return true;
 	}
 
 	// catch EndOfLine's
 	if (isBreak(c)) {
-		return new Token(Token::EndOfLine, "\\n", startRow, startCol, startRow+1, 1);
+		finishView(view, Token::EndOfLine);
+		return true;
 	}
 
 	// catch comments
 	if (cType == Token::Comment) {
-		QString look;
 		do {
-			look += c;
 			c = getChar();
 		} while (!isBreak(c) && !atEnd);
 		ungetChar();
-		return new Token(Token::Comment, look, startRow, startCol, row, col);
+		finishView(view, Token::Comment);
+		return true;
 	}
 
 	// catch strings
 	if (cType == Token::StringDelimiter) {
-		QString look = QString(c);
 		do {
 			c = getChar();
-			look += c;
-		} while (!(translator->look2type(c) == Token::StringDelimiter && look.right(2) != "\\\"") &&
+		} while (!(translator->look2type(c) == Token::StringDelimiter && inputString.at(at - 2) != '\\') &&
 		         !isBreak(c) && !atEnd);
-		return new Token(Token::String, look, startRow, startCol, row, col);
+		finishView(view, Token::String);
+		return true;
 	}
 
 	// catch variables
 	if (cType == Token::VariablePrefix) {
-		QString look;
 		do {
-			look += c;
 			c = getChar();
 		} while (isWordChar(c) || c.category() == QChar::Number_DecimalDigit || c == '_');
 		ungetChar();
-		return new Token(Token::Variable, look, startRow, startCol, row, col);
+		finishView(view, Token::Variable);
+		return true;
 	}
 
 	// catch words (known commands or function calls)
 	if (isWordChar(c)) {  // first char has to be a letter
-		QString look;
 		do {
-			look += c;
 			c = getChar();
-		} while (isWordChar(c) || c.isDigit() || c == '_');  // next chars
+		} while (isWordChar(c) || isDigit(c) || c == '_');  // next chars
 		ungetChar();
-		int type = translator->look2type(look);
+		int type = lookupType(view.start, at - view.start);
 		if (type == Token::Unknown)
 			type = Token::FunctionCall;
-		return new Token(type, look, startRow, startCol, row, col);
+		finishView(view, type);
+		return true;
 	}
 
 	// catch numbers
-	if (c.isDigit() || cType == Token::DecimalSeparator) {
+	if (isDigit(c) || cType == Token::DecimalSeparator) {
 		bool hasDot = false;
 
 		int localType = cType;
-		QString look;
 		do {
 			if (localType == Token::DecimalSeparator) hasDot = true;
-			look += c;
 			c = getChar();
 			localType = translator->look2type(c);
-		} while (c.isDigit() || (localType == Token::DecimalSeparator && !hasDot));
+		} while (isDigit(c) || (localType == Token::DecimalSeparator && !hasDot));
 		ungetChar();
-		
+
 		// if all we got is a dot then this is not a number, so return an Error token here
-		if (translator->look2type(look) == Token::DecimalSeparator)
-			return new Token(Token::Error, look, startRow, startCol, row, col);
-		
-		return new Token(Token::Number, look, startRow, startCol, row, col);
+		finishView(view, (at - view.start == 1 && cType == Token::DecimalSeparator) ? Token::Error : Token::Number);
+		return true;
 	}
 
 	// catch previously uncatched 'double charactered tokens' (tokens that ar not in letters, like: == != >= <=)
-	{
-		QString look = QString(c).append(getChar());
-		int type = translator->look2type(look);
-		if (type != Token::Unknown)
-			return new Token(type, look, startRow, startCol, row, col);
-		ungetChar();
+	if (at < inputString.size()) {
+		int type = lookupType(view.start, 2);
+		if (type != Token::Unknown) {
+			getChar();
+			finishView(view, type);
+			return true;
+		}
 	}
 
 	// catch known tokens of a single character (as last...)
-	if (cType != Token::Unknown)
-		return new Token(cType, static_cast<QString>(c), startRow, startCol, row, col);
-
 	// this does not neglect calls to functions with a name of length one (checked it)
-	return new Token(Token::Error, static_cast<QString>(c), startRow, startCol, row, col);
+	finishView(view, cType != Token::Unknown ? cType : Token::Error);
+	return true;
+}
+
+
+void Tokenizer::finishView(TokenView& view, int type)
+{
+	view.type   = type;
+	view.length = at - view.start;
+	view.endRow = row;
+	view.endCol = col;
+}
+
+
+int Tokenizer::lookupType(int start, int length)
+{
+	lookBuffer.setRawData(inputString.constData() + start, length);
+	return translator->look2type(lookBuffer);
 }
 
 
@@ -188,6 +247,8 @@ void Tokenizer::ungetChar()
 
 bool Tokenizer::isWordChar(const QChar& c)
 {
+	if (c.unicode() < ASCII_TABLE_SIZE) return asciiClasses.flags[c.unicode()] & WordCharacter;
+
 	// this method exists because some languages have non-letter category characters
 	// mixed with their letter character to make words (like hindi)
 	// NOTE: this has to be extended then languages give problems,
@@ -206,6 +267,7 @@ bool Tokenizer::isBreak(const QChar& c)
 
 bool Tokenizer::isSpace(const QChar& c)
 {
+	if (c.unicode() < ASCII_TABLE_SIZE) return asciiClasses.flags[c.unicode()] & SpaceCharacter;
 	return (c.category() == QChar::Separator_Space || c == ' ' || isTab(c));
 }
 
@@ -213,3 +275,9 @@ bool Tokenizer::isTab(const QChar& c)
 {
 	return (c == '\x09' || c == '\t');
 }
+
+bool Tokenizer::isDigit(const QChar& c)
+{
+	if (c.unicode() < ASCII_TABLE_SIZE) return asciiClasses.flags[c.unicode()] & DigitCharacter;
+	return c.isDigit();
+}
@@ -28,6 +28,19 @@
 #include "translator.h"
 
 
+/**
+ * @short A token as found by Tokenizer::scan().
+ * Instead of a look of its own it has the position of the look in the input string,
+ * use Tokenizer::look() to get the look.
+ */
+typedef struct {
+	int type;
+	int start;   // offset of the first character in the input string
+	int length;  // number of characters in the input string
+	int startRow, startCol, endRow, endCol;
+} TokenView;
+
+
 /**
  * @short Generates Token objects from a QString using the Translator.
  *
@@ -66,6 +79,25 @@ class Tokenizer
 		 */
 		Token* getToken();
 
+		/**
+		 * Like getToken(), but fills @p view instead of allocating a Token.
+		 * This is the fast path used by the Highlighter, getToken() is built on it.
+		 * @returns FALSE when the end of the input is reached (@p view then is EndOfInput)
+		 */
+		bool scan(TokenView& view);
+
+		/** @returns the look of a TokenView, as getToken() would have given it */
+		QString look(const TokenView& view) const;
+
+		/** @returns a newly created Token made from @p view */
+		Token* toToken(const TokenView& view) const;
+
+		/** @returns the amount of characters of the input that are read so far */
+		int position() const { return at; }
+
+		/** @returns the amount of characters of the input */
+		int length() const { return inputString.length(); }
+
 
 	private:
 		QChar getChar();    // gets a the next QChar and sets the row and col accordingly
@@ -74,9 +106,17 @@ class Tokenizer
 		static bool isBreak(const QChar& c);
 		static bool isSpace(const QChar& c);
 		static bool isTab(const QChar& c);
+		static bool isDigit(const QChar& c);
+
+		/// Sets the type, length and end position of @p view when the tokenizer is just past it
+		void finishView(TokenView& view, int type);
+
+		/// Points lookBuffer to a part of the input string (without copying it) for a look2type() lookup
+		int lookupType(int start, int length);
 
 		Translator *translator;
 		QString     inputString;
+		QString     lookBuffer;  // raw data view on inputString, see lookupType()
 
 		int at, row, col, prevCol;
 
@@ -33,8 +33,9 @@ Translator* Translator::instance()
 }
 
 Translator::Translator()
-	: localizer(QStringList() << DEFAULT_LANGUAGE_CODE)
+	: localizer(QStringList() << DEFAULT_LANGUAGE_CODE), m_dictionaryVersion(0)
 {
+	fillAsciiTable();
 }
 
 Translator::~Translator()
@@ -51,8 +52,10 @@ int Translator::look2type(QString& look)
 	return Token::Unknown;
 }
 
-int Translator::look2type(QChar& look)
+int Translator::look2type(const QChar& look)
 {
+	if (look.unicode() < ASCII_TABLE_SIZE)
+		return asciiLook2type[look.unicode()];
 	if (look2typeMap.contains(static_cast<QString>(look)))
 		return look2typeMap[static_cast<QString>(look)];
 	return Token::Unknown;
@@ -79,6 +82,7 @@ bool Translator::setLanguage(const QString &lang_code)
 
 	setDictionary();
 	setExamples();
+	m_dictionaryVersion++;
 
 	return true;
 }
@@ -660,6 +664,20 @@ void Translator::setDictionary()
 
 //END GENERATED translator_cpp CODE
 
+	fillAsciiTable();
+}
+
+
+void Translator::fillAsciiTable()
+{
+	for (int i = 0; i < ASCII_TABLE_SIZE; i++)
+		asciiLook2type[i] = Token::Unknown;
+
+	QHash<QString, int>::const_iterator i;
+	for (i = look2typeMap.constBegin(); i != look2typeMap.constEnd(); ++i) {
+		if (i.key().length() == 1 && i.key().at(0).unicode() < ASCII_TABLE_SIZE)
+			asciiLook2type[i.key().at(0).unicode()] = i.value();
+	}
 }
 
 
@@ -759,17 +777,20 @@ void Translator::setExamples()
 
 QString Translator::localizeScript(const QString& untranslatedScript)
 {
-	QString result = untranslatedScript;
+	// the result is built in one pass, replacing in place moves the rest of the script for every match
+	QString result;
+	result.reserve(untranslatedScript.length());
 	Translator* translator = Translator::instance();
 	QRegExp rx("@\\(.*\\)");
 	rx.setMinimal(true);  // make it not greedy
 
-	int pos = 0;
-	while ((pos = rx.indexIn(result, pos)) != -1) {
-		QString original = result.mid(pos, rx.matchedLength());
-		original = original.mid(2, original.length() - 3);
-		result = result.replace(pos, rx.matchedLength(), translator->default2localized(original));
+	int pos, last = 0;
+	while ((pos = rx.indexIn(untranslatedScript, last)) != -1) {
+		result += untranslatedScript.midRef(last, pos - last);
+		result += translator->default2localized(untranslatedScript.mid(pos + 2, rx.matchedLength() - 3));
+		last = pos + rx.matchedLength();
 	}
+	result += untranslatedScript.midRef(last);
 
 	return result;
 }
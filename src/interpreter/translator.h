@@ -29,6 +29,8 @@
 
 static const char* DEFAULT_LANGUAGE_CODE = "en_US";
 
+static const int ASCII_TABLE_SIZE = 128;
+
 /**
  * @short Uses an XML dictionary to translate unicode strings to Token types (if possible).
  *
@@ -58,6 +60,12 @@ class Translator
 		    @returns TRUE is the loading was successful, otherwise FALSE */
 		bool setLanguage(const QString &lang_code = QString(DEFAULT_LANGUAGE_CODE));
 
+		/// @returns the ISO language code of the current dictionary, as set by setLanguage()
+		QString language() const { return localizer.first(); }
+
+		/// @returns a number that changes every time setLanguage() replaces the dictionary (for caches of Token types)
+		int dictionaryVersion() const { return m_dictionaryVersion; }
+
 		/** @short Converts a unicode string to a token type.
 		    Uses the dictionary to do so.
 		    If the string could not translated to a Token type, Token::Unknown is returned.
@@ -67,9 +75,10 @@ class Translator
 
 		/** @short Converts a unicode character to a token type.
 		    Overloaded for convenience, behaves like the method it overloads.
+		    ASCII characters are looked up in a table, so no QString is made for them.
 		    @param   look one unicode character of KTurtle code
 		    @returns the token type, Token::Unknown if not recognised */
-		int look2type(QChar& look);
+		int look2type(const QChar& look);
 
 		/** @short Converts a token type into a list of commands associated with it.
 		    This method is slow compared to the inverse, look2type(), methods
@@ -82,7 +91,7 @@ class Translator
 
 		QHash<int, QList<QString> > token2stringsMap();
 
-		QString default2localized(const QString& defaultLook) { return default2localizedMap[defaultLook]; }
+		QString default2localized(const QString& defaultLook) const { return default2localizedMap.value(defaultLook); }
 
 		/// returns all default looks that have a localized look (for translating examples in main.cpp)
 		QStringList allDefaultLooks() { return QStringList(default2localizedMap.keys()); }
@@ -115,13 +124,16 @@ class Translator
 
 		void setDictionary();
 		void setExamples();
+		void fillAsciiTable();
 
 		QHash<QString, QString> examples;
 
 		QHash<QString, int> look2typeMap;
+		int asciiLook2type[ASCII_TABLE_SIZE];  // look2typeMap for the one character ASCII looks
 		QHash<QString, QString> default2localizedMap;
 
 		QStringList localizer;
+		int m_dictionaryVersion;
 };
 
 
@@ -24,16 +24,9 @@
 
 TreeNode::~TreeNode()
 {
-	if (childList != 0) {
-		// this should work here:
-		qDeleteAll(*childList);
-		childList->clear();
-
-		// but this is nicer (and probably less optimal):
-		// while (!list.isEmpty()) delete list.takeFirst();
-	}
-	delete _value;
-	delete _token;
+	foreach (TreeNode* child, childList)
+		if (!Arena::owns(child)) delete child;
+	if (!Arena::owns(_token)) delete _token;
 }
 
 
@@ -41,17 +34,21 @@ void TreeNode::init(TreeNode* parent, Token* token)
 {
 	setParent(parent);
 	setToken(token);
-	childList = 0;
 	currentChildIndex = -1;
-	_value = 0;
+	_childIndex = -1;
+	_slot = -1;
+	_localSlot = -1;
+	_link = 0;
+	_numericOperands = false;
+	_hasValue = false;
 }
 
 
 void TreeNode::appendChild(TreeNode* newChild)
 {
-	if (childList == 0) childList = new ChildList();
 	newChild->setParent(this);
-	childList->append(newChild);
+	newChild->_childIndex = childList.size();
+	childList.append(newChild);
 // // // 		QString out = QString("TreeNode::appendChild(): \"%5\" [%6] @ (%1,%2)-(%3,%4) to parent '%7'")
 // // // 			.arg(newChild->token()->startRow())
 // // // 			.arg(newChild->token()->startCol())
@@ -64,40 +61,63 @@ void TreeNode::appendChild(TreeNode* newChild)
 }
 
 
+void TreeNode::insertChild(int i, TreeNode* newChild)
+{
+	newChild->setParent(this);
+	childList.insert(i, newChild);
+	for (int j = i; j < childList.size(); j++)
+		childList.at(j)->_childIndex = j;
+}
+
+void TreeNode::replaceChild(int i, TreeNode* newChild)
+{
+	newChild->setParent(this);
+	newChild->_childIndex = i;
+	childList[i] = newChild;
+}
+
+void TreeNode::removeChild(int i)
+{
+	childList.removeAt(i);
+	for (int j = i; j < childList.size(); j++)
+		childList.at(j)->_childIndex = j;
+}
+
+void TreeNode::setChildren(const QList<TreeNode*>& children)
+{
+	childList = children;
+	for (int j = 0; j < childList.size(); j++) {
+		childList.at(j)->setParent(this);
+		childList.at(j)->_childIndex = j;
+	}
+}
+
 
 TreeNode* TreeNode::child(int i)
 {
-	if (childList == 0) return 0;
-	if (0 <= i && i < childList->size()) return childList->at(i);
+	if (0 <= i && i < childList.size()) return childList.at(i);
 	return 0;
 }
 
 
 TreeNode* TreeNode::firstChild()
 {
-	if (childList == 0 || childList->isEmpty()) return 0;
+	if (childList.isEmpty()) return 0;
 	currentChildIndex = 0;
-	return childList->first();
+	return childList.first();
 }
 
 TreeNode* TreeNode::nextChild()
 {
-	if (childList == 0) return 0;
 	currentChildIndex++;
 	return child(currentChildIndex);
 }
 
 
-int TreeNode::findChildIndex(TreeNode* child)
-{
-	return childList->indexOf(child);
-}
-
-
 TreeNode* TreeNode::nextSibling()
 {
 	if (_parent == 0) return 0;
-	return _parent->child(_parent->findChildIndex(this)+1);
+	return _parent->child(_childIndex + 1);
 }
 
 
@@ -111,11 +131,10 @@ QString TreeNode::toString()
 // recursively walk through tree and show node names with indentation
 void TreeNode::showTree(QString& str, int indent)
 {
-	if (childList == 0) return;
 	indent++;
 	TreeNode* node;
-	for (int i = 0; i < childList->size(); i++) {
-		node = childList->at(i);
+	for (int i = 0; i < childList.size(); i++) {
+		node = childList.at(i);
 		node->show(str, indent);
 		node->showTree(str, indent);
 	}
@@ -23,6 +23,7 @@
 #include <QList>
 
 
+#include "arena.h"
 #include "token.h"
 #include "value.h"
 
@@ -34,10 +35,11 @@
  * The TreeNode object is a node in the node tree as created by the Parser.
  * It can be executed by the Executer.
  *
- * The list of pointers to the children of the TreeNode is only created
- * when it is needed.
  * Each TreeNode has a list of pointers to its children, a pointer to its
- * parent, a pointer to one Token, and can also have a pointer to a Value.
+ * parent, a pointer to one Token, and can also have a Value (kept inline).
+ *
+ * TreeNodes made by the Parser live in the Arena of the Interpreter, which
+ * destroys them all at once (see Arena::release()).
  *
  * @author Cies Breijs
  */
@@ -53,12 +55,17 @@ class TreeNode
 
 		/**
 		 * @short Destructor.
-		 * This deletes the Value and the Token associated with this TreeNode.
+		 * This deletes the Token associated with this TreeNode.
 		 * The childList auto-deletes all the children, which means that deleting
-		 * the root node deletes the whole tree.
+		 * the root node deletes the whole tree. Children and Tokens that live in
+		 * an Arena are left to Arena::release().
 		 */
 		virtual ~TreeNode();
 
+		/// TreeNodes are placed in the active Arena, if there is one
+		static void* operator new(size_t size) { return Arena::allocateTreeNode(size); }
+		static void  operator delete(void* p)  { Arena::deallocate(p); }
+
 
 
 		/** @returns the pointer to the parent TreeNode. @see setParent() */
@@ -68,7 +75,7 @@ class TreeNode
 		Token*    token()                       { return _token; }
 
 		/** @returns the pointer to assiciated Value. @see setValue() @see setNullValue() */
-		Value*    value()                       { if (_value == 0) _value = new Value(); return _value; }
+		Value*    value()                       { _hasValue = true; return &_value; }
 
 
 
@@ -78,22 +85,22 @@ class TreeNode
 		/** Sets the pointer to the associated token to @p token. @see token() and @see TreeNode() */
 		void      setToken(Token* token)        { _token = token; }
 
-		/** Sets the pointer to the associated value to @p value. @see setNullValue() @see value() */
-		void      setValue(Value value)         { delete _value; _value = new Value(value); }
+		/** Sets the associated value to @p value. @see setNullValue() @see value() */
+		void      setValue(const Value& value)  { _value = value; _hasValue = true; }
 
-		/** Sets the pointer to the associated value to zero. @see setValue() @see value() */
-		void      setNullValue()                {  delete _value; _value = 0;  } // appears Empty (see value())
+		/** Removes the associated value. @see setValue() @see value() */
+		void      setNullValue()                { _value.setNull(); _hasValue = false; } // appears Empty (see value())
 
 
 
 		/** @returns TRUE is the TreeNode has an associated Value. @see value @see setValue */
-		bool      hasValue() const              { return _value != 0; }
+		bool      hasValue() const              { return _hasValue; }
 
 		/** @returns TRUE is the TreeNode has children. @see childCount @see appendChild */
-		bool      hasChildren() const           { if (childList == 0) return false; else return !childList->isEmpty(); }
+		bool      hasChildren() const           { return !childList.isEmpty(); }
 
 		/** @returns the amount of children. @see appendChild @see hasChildren */
-		uint      childCount() const            { if (childList == 0) return 0; else return childList->size(); }
+		uint      childCount() const            { return childList.size(); }
 
 		/**
 		 * Appends the pointer to the TreeNode @p newChild to the childList and
@@ -101,6 +108,18 @@ class TreeNode
 		 */
 		void      appendChild(TreeNode* newChild);
 
+		/** Inserts @p newChild as child number @p i, and sets the child's parent to this. */
+		void      insertChild(int i, TreeNode* newChild);
+
+		/** Replaces child number @p i by @p newChild. The old child is not deleted. */
+		void      replaceChild(int i, TreeNode* newChild);
+
+		/** Removes child number @p i from the childList. The child is not deleted. */
+		void      removeChild(int i);
+
+		/** Replaces all children by @p children in one go, so a pass that replaces many of them renumbers them once. The old children are not deleted. */
+		void      setChildren(const QList<TreeNode*>& children);
+
 
 
 		/** @returns the pointer to child number @p i (zero if the child does not exists). This does not change the current child. */
@@ -116,6 +135,31 @@ class TreeNode
 		/** @returns the pointer to the next sibling; the next child of the parent (zero if the next sibling does not exists) */
 		TreeNode* nextSibling();
 
+		/** @returns the index of this node in the childList of its parent (-1 when it has no parent) */
+		int       childIndex() const            { return _childIndex; }
+
+
+		/** @returns the global variable slot of a Variable node, or the amount of local slots of a Learn node (-1 when not resolved). @see Resolver */
+		int       slot() const                  { return _slot; }
+
+		/** @returns the local variable slot of a Variable node in a learned function, otherwise -1. @see Resolver */
+		int       localSlot() const             { return _localSlot; }
+
+		/** Sets the global and local variable slots of a Variable node. @see slot() @see localSlot() */
+		void      setSlots(int slot, int localSlot) { _slot = slot; _localSlot = localSlot; }
+
+		/** @returns the Learn node a FunctionCall node is linked to (zero when not linked yet). @see setLink() */
+		TreeNode* link()                        { return _link; }
+
+		/** Links a FunctionCall node to the Learn node of the function it calls. @see link() */
+		void      setLink(TreeNode* learnNode)  { _link = learnNode; }
+
+		/** @returns TRUE when both operands of an arithmetic or comparison node are always numbers. @see TypeInferrer */
+		bool      hasNumericOperands() const    { return _numericOperands; }
+
+		/** Sets whether both operands are always numbers. @see hasNumericOperands() */
+		void      setNumericOperands(bool numeric) { _numericOperands = numeric; }
+
 
 		/** @returns the node tree, starting from 'this' node, as a multi line string */
 		QString toString();
@@ -132,15 +176,13 @@ class TreeNode
 		/** Prints an indented string describing itself to de debug info */
 		void showTree(QString& str, int indent = 0);
 
-		int findChildIndex(TreeNode* child);
-	
 		/// typedef for the ChildList.
 		typedef QList<TreeNode*>         ChildList;
 
-		/// The childList, contains pointers to the children of this node.
-		ChildList                       *childList;
+		/// The childList, contains pointers to the children of this node (an empty QList does not allocate).
+		ChildList                        childList;
 
-		/// Keeps track of the index of the current child. Zero when no child list is available.
+		/// Keeps track of the index of the current child. -1 when no child was requested yet.
 		int                              currentChildIndex;
 
 
@@ -148,11 +190,27 @@ class TreeNode
 		/// The pointer to the parent of this TreeNode.
 		TreeNode                        *_parent;
 
+		/// The index of this TreeNode in the childList of the parent, so siblings are found without searching.
+		int                              _childIndex;
+
+		/// The variable slots of a Variable node, as set by the Resolver (-1 when not used).
+		int                              _slot;
+		int                              _localSlot;
+
+		/// The Learn node a FunctionCall node calls, as linked by the Executer (can be zero).
+		TreeNode                        *_link;
+
+		/// TRUE when the operands of this node are proven to be numbers, as set by the TypeInferrer.
+		bool                             _numericOperands;
+
 		/// The pointer to the token associated with this TreeNode (cannot be zero).
 		Token                           *_token;
 
-		/// The pointer to the value associated with this TreeNode (can be zero).
-		Value                           *_value;
+		/// The value associated with this TreeNode, stored inline so it needs no allocation.
+		Value                            _value;
+
+		/// TRUE when the value was set or asked for. @see hasValue()
+		bool                             _hasValue;
 };
 
 #endif  // _TREENODE_H_
@@ -0,0 +1,157 @@
+/*
+	Copyright (C) 2026 agent <agent AT local>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public
+	License as published by the Free Software Foundation; either
+	version 2 of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to the Free
+	Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+	Boston, MA 02110-1301, USA.
+*/
+
+#include "typeinferrer.h"
+
+
+
+void TypeInferrer::infer(TreeNode* rootNode)
+{
+	assignedNames.clear();
+	assignedValues.clear();
+	learnNodes.clear();
+	callNodes.clear();
+	nonNumeric.clear();
+
+	collect(rootNode);
+
+	// the arguments of a call are assigned to the parameters of every function with that name
+	foreach (TreeNode* call, callNodes) {
+		foreach (TreeNode* learn, learnNodes) {
+			TreeNode* parameters = learn->child(1);
+			if (learn->child(0)->token()->look() != call->token()->look() ||
+			    parameters->childCount() != call->childCount()) continue;
+			for (uint i = 0; i < call->childCount(); i++) {
+				assignedNames.append(parameters->child(i)->token()->look());
+				assignedValues.append(call->child(i));
+			}
+		}
+	}
+
+	// all variables are assumed to be numeric until a value that is not
+	// proves otherwise, which can change the values that depend on them
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		for (int i = 0; i < assignedNames.size(); i++) {
+			if (nonNumeric.contains(assignedNames.at(i)) || isNumeric(assignedValues.at(i))) continue;
+			nonNumeric.insert(assignedNames.at(i), true);
+			changed = true;
+		}
+	}
+
+	mark(rootNode);
+}
+
+
+void TypeInferrer::collect(TreeNode* node)
+{
+	switch (node->token()->type()) {
+		case Token::Assign:
+			if (node->childCount() == 2) {
+				assignedNames.append(node->child(0)->token()->look());
+				assignedValues.append(node->child(1));
+			}
+			break;
+
+		case Token::Learn:
+			if (node->childCount() >= 3) learnNodes.append(node);
+			break;
+
+		case Token::FunctionCall:
+			if (node->parent()->token()->type() != Token::Learn) callNodes.append(node);
+			break;
+
+		default:  // a for loop always assigns a number
+			break;
+	}
+
+	for (uint i = 0; i < node->childCount(); i++)
+		collect(node->child(i));
+}
+
+
+void TypeInferrer::mark(TreeNode* node)
+{
+	for (uint i = 0; i < node->childCount(); i++)
+		mark(node->child(i));
+
+	switch (node->token()->type()) {
+		case Token::Equals:
+		case Token::NotEquals:
+		case Token::GreaterThan:
+		case Token::LessThan:
+		case Token::GreaterOrEquals:
+		case Token::LessOrEquals:
+		case Token::Addition:
+		case Token::Substracton:
+		case Token::Multiplication:
+		case Token::Division:
+		case Token::Power:
+			node->setNumericOperands(node->childCount() == 2 && isNumeric(node->child(0)) && isNumeric(node->child(1)));
+			break;
+
+		default:
+			break;
+	}
+}
+
+
+bool TypeInferrer::isNumeric(TreeNode* node)
+{
+	uint count = node->childCount();
+
+	switch (node->token()->type()) {
+		case Token::Number:
+		case Token::Pi:
+			return true;
+
+		case Token::Variable:
+			// when it is not assigned an error is reported, see Executer::executeVariable()
+			return !nonNumeric.contains(node->token()->look());
+
+		case Token::GetX:
+		case Token::GetY:
+		case Token::GetDirection:
+			return count == 0;
+
+		case Token::Tan:
+		case Token::Sin:
+		case Token::Cos:
+		case Token::ArcTan:
+		case Token::ArcSin:
+		case Token::ArcCos:
+		case Token::Sqrt:
+		case Token::Round:
+			return count == 1;
+
+		case Token::Addition:
+		case Token::Substracton:
+		case Token::Multiplication:
+		case Token::Division:
+		case Token::Power:
+		case Token::Random:
+		case Token::Mod:
+			// on operands that are not numbers these report errors and keep their old value
+			return count == 2 && isNumeric(node->child(0)) && isNumeric(node->child(1));
+
+		default:
+			return false;
+	}
+}
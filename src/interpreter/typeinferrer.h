@@ -0,0 +1,88 @@
+/*
+	Copyright (C) 2026 agent <agent AT local>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public
+	License as published by the Free Software Foundation; either
+	version 2 of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to the Free
+	Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+	Boston, MA 02110-1301, USA.
+*/
+
+#ifndef _TYPEINFERRER_H_
+#define _TYPEINFERRER_H_
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include "treenode.h"
+
+
+
+/**
+ * @short Finds the expressions of a node tree that always yield a number.
+ *
+ * The TypeInferrer walks the node tree, as yielded by the Parser, once before
+ * it is executed. It marks the arithmetic and comparison nodes of which both
+ * operands are proven to be numbers (see TreeNode::hasNumericOperands()), the
+ * Executer runs those without checking the amount and the types of the
+ * operands. All other nodes keep using the generic execute* methods, so
+ * adding strings or comparing them still works like before.
+ *
+ * A variable is numeric when every value that can be assigned to it, by '=',
+ * by a for loop or as the argument of a learned function, is numeric. Since
+ * variables are checked by name, and not per scope, assigning a string to
+ * '$x' anywhere in the program makes '$x' non-numeric everywhere.
+ */
+class TypeInferrer
+{
+	public:
+		/**
+		 * @short Constructor. Does nothing special.
+		 */
+		TypeInferrer() {}
+
+		/**
+		 * @short Destructor. Does nothing special.
+		 */
+		~TypeInferrer() {}
+
+		/**
+		 * @short Marks the nodes with numeric operands of the tree starting at @p rootNode.
+		 */
+		void         infer(TreeNode* rootNode);
+
+
+	private:
+		/// Collects the assignments, learned functions and function calls of @p node and its children
+		void         collect(TreeNode* node);
+
+		/// Marks @p node and its children, when their operands are numeric
+		void         mark(TreeNode* node);
+
+		/// @returns TRUE when the value of @p node is a number whenever it is executed without errors
+		bool         isNumeric(TreeNode* node);
+
+		/// The variable names of the assignments and the values they get
+		QList<QString>            assignedNames;
+		QList<TreeNode*>          assignedValues;
+
+		/// The Learn nodes and the FunctionCall nodes (that do not define a function)
+		QList<TreeNode*>          learnNodes;
+		QList<TreeNode*>          callNodes;
+
+		/// The names of the variables that can get a value that is not a number
+		QHash<QString, bool>      nonNumeric;
+};
+
+
+#endif  // _TYPEINFERRER_H_
@@ -19,26 +19,14 @@
 
 #include "value.h"
 
+#include <new>  // for placement new
+
 #include <QDebug>
 //#include <QLocale>
 
 #include "translator.h"  // for the boolean (true and false) to string translation
 
 
-Value::Value()
-{
-	init();
-}
-
-Value::Value(Value* n) :
-	m_type(n->type()),
-	m_bool(n->boolean()),
-	m_double(n->number()),
-	m_string(n->string())
-{
-}
-
-
 void Value::setType(int newType)  // maybe someday we have to do some type casting logic here
 {
 	if (m_type == newType) {
@@ -57,8 +45,7 @@ void Value::setType(int newType)  // maybe someday we have to do some type casti
 				break;
 	
 			case Value::String:
-				init();
-				m_type = newType;
+				setString(QLatin1String(""));
 				break;
 	
 			case Value::Empty:
@@ -84,6 +71,7 @@ bool Value::boolean() const
 
 void Value::setBool(bool b)
 {
+	releaseString();
 	m_type = Value::Bool;
 	m_bool = b;
 }
@@ -100,7 +88,7 @@ double Value::number() const
 
 		case Value::String:
 			bool ok = true;
-			double num = m_string.toDouble(&ok);
+			double num = stringData().toDouble(&ok);
 			if (ok) return num;
 	}
 	return 0;  // Value::String, Value::Empty
@@ -108,21 +96,17 @@ double Value::number() const
 
 void Value::setNumber(double d)
 {
+	releaseString();
 	m_type = Value::Number;
 	m_double = d;
 }
 
 bool Value::setNumber(const QString &s)
 {
-	m_type = Value::Number;
 	bool ok = true;
 	double num = s.toDouble(&ok);
-	if (ok) {
-		m_double = num;
-		return true;
-	}
-	m_double = 0;
-	return false;
+	setNumber(ok ? num : 0);
+	return ok;
 }
 
 
@@ -137,38 +121,44 @@ QString Value::string() const
 		QString s;
 		s.setNum(m_double);
 		return s;
+	} else if (m_type == Value::String) {
+		return stringData();
 	}
-	return m_string;  // Value::String, Value::Empty
+	return QLatin1String("");  // Value::Empty
 }
 
 void Value::setString(double d)
 {
-	m_type = Value::String;
-	m_double = d;
-	m_string.setNum(d);
+	QString s;
+	s.setNum(d);
+	setString(s);
 }
 
 void Value::setString(const QString &s)
 {
+	if (m_type == Value::String) {
+		stringData() = s;
+		return;
+	}
+	new (m_storage) QString(s);
 	m_type = Value::String;
-	m_string = s;
 }
 
 
 
-Value& Value::operator=(Value* n)
+Value& Value::operator=(const Value& n)
 {
-	switch (n->type()) {
+	switch (n.m_type) {
 		case Value::Bool:
-			setBool(n->boolean());
+			setBool(n.m_bool);
 			break;
 
 		case Value::Number:
-			setNumber(n->number());
+			setNumber(n.m_double);
 			break;
 
 		case Value::String:
-			setString(n->string());
+			setString(n.stringData());
 			break;
 
 		case Value::Empty:
@@ -182,6 +172,11 @@ Value& Value::operator=(Value* n)
 	return *this;
 }
 
+Value& Value::operator=(Value* n)
+{
+	return *this = *n;
+}
+
 
 Value& Value::operator=(const QString& s)
 {
@@ -202,8 +197,7 @@ Value& Value::operator+(Value* n)
 	if (m_type == Value::Number && n->type() == Value::Number) {
 		m_double += n->number();
 	} else {
-		m_type = Value::String;
-		m_string = string() + n->string();
+		setString(string() + n->string());
 	}
 	return *this;
 }
@@ -247,7 +241,7 @@ bool Value::operator==(Value* n) const
 {
 	if (m_type == Value::Bool   && n->type() == Value::Bool)   return m_bool == n->boolean();
 	if (m_type == Value::Number && n->type() == Value::Number) return m_double == n->number();
-	if (m_type == Value::String && n->type() == Value::String) return m_string == n->string();
+	if (m_type == Value::String && n->type() == Value::String) return stringData() == n->stringData();
 	if (m_type == Value::Empty  && n->type() == Value::Empty)  return true;
 	return false;
 }
@@ -257,7 +251,7 @@ bool Value::operator!=(Value* n) const
 {
 	if (m_type == Value::Bool   && n->type() == Value::Bool)   return m_bool != n->boolean();
 	if (m_type == Value::Number && n->type() == Value::Number) return m_double != n->number();
-	if (m_type == Value::String && n->type() == Value::String) return m_string != n->string();
+	if (m_type == Value::String && n->type() == Value::String) return stringData() != n->stringData();
 	// if (m_type == Value::Empty && n->type() == Value::Empty)   return false;
 	return false;
 }
@@ -267,7 +261,7 @@ bool Value::operator<(Value* n) const
 {
 	if (m_type == Value::Bool   && n->type() == Value::Bool)   return m_bool < n->boolean();
 	if (m_type == Value::Number && n->type() == Value::Number) return m_double < n->number();
-	if (m_type == Value::String && n->type() == Value::String) return m_string.length() < n->string().length();
+	if (m_type == Value::String && n->type() == Value::String) return stringData().length() < n->stringData().length();
 	// if (m_type == Value::Empty && n->type() == Value::Empty)   return false;
 	return false;
 }
@@ -277,7 +271,7 @@ bool Value::operator<=(Value* n) const
 {
 	if (m_type == Value::Bool   && n->type() == Value::Bool)   return m_bool <= n->boolean();
 	if (m_type == Value::Number && n->type() == Value::Number) return m_double <= n->number();
-	if (m_type == Value::String && n->type() == Value::String) return m_string.length() <= n->string().length();
+	if (m_type == Value::String && n->type() == Value::String) return stringData().length() <= n->stringData().length();
 	if (m_type == Value::Empty  && n->type() == Value::Empty)  return true;
 	return false;
 }
@@ -287,7 +281,7 @@ bool Value::operator>(Value* n) const
 {
 	if (m_type == Value::Bool   && n->type() == Value::Bool)   return m_bool > n->boolean();
 	if (m_type == Value::Number && n->type() == Value::Number) return m_double > n->number();
-	if (m_type == Value::String && n->type() == Value::String) return m_string.length() > n->string().length();
+	if (m_type == Value::String && n->type() == Value::String) return stringData().length() > n->stringData().length();
 	// if (m_type == Value::Empty && n->type() == Value::Empty)   return false;
 	return false;
 }
@@ -297,7 +291,7 @@ bool Value::operator>=(Value* n) const
 {
 	if (m_type == Value::Bool   && n->type() == Value::Bool)   return m_bool >= n->boolean();
 	if (m_type == Value::Number && n->type() == Value::Number) return m_double >= n->number();
-	if (m_type == Value::String && n->type() == Value::String) return m_string.length() >= n->string().length();
+	if (m_type == Value::String && n->type() == Value::String) return stringData().length() >= n->stringData().length();
 	if (m_type == Value::Empty  && n->type() == Value::Empty)  return true;
 	return false;
 }
@@ -308,10 +302,9 @@ bool Value::operator>=(Value* n) const
 
 void Value::init()
 {
+	releaseString();
 	m_type = Value::Empty;  // init'ed values are empty by default
-	m_bool = false;
 	m_double = 0;
-	m_string = "";
 }
 
 
@@ -38,6 +38,11 @@
  *
  * By default a Value is Empty.
  *
+ * Only the field of the current type is stored: booleans and numbers are
+ * kept inline and a QString is only constructed for the String type, so
+ * copying a Number is as cheap as copying a double. Numbers and booleans are
+ * only converted to strings when string() is asked for.
+ *
  * @TODO a way to easily generate ErrorMessages from this class
  *
  * @author Cies Breijs
@@ -53,13 +58,14 @@ class Value
 			String
 		};
 
-		Value();
-		Value(Value*);
+		Value() : m_double(0), m_type(Empty) {}
+		Value(Value* n) : m_type(Empty) { *this = *n; }
+		Value(const Value& n) : m_type(Empty) { *this = n; }
 
-		Value(bool b)           { setBool(b); }
-		Value(double d)         { setNumber(d); }
-		Value(const QString& s) { setString(s); }
-		~Value() {}
+		Value(bool b)           : m_bool(b), m_type(Bool) {}
+		Value(double d)         : m_double(d), m_type(Number) {}
+		Value(const QString& s) : m_type(Empty) { setString(s); }
+		~Value()                { releaseString(); }
 	
 		int      type() const { return m_type; }
 		void     setType(int);
@@ -77,6 +83,7 @@ class Value
 		void     setString(double);
 		void     setString(const QString&);
 	
+		Value&   operator=(const Value&);
 		Value&   operator=(Value*);
 		Value&   operator=(const QString&);
 		Value&   operator=(double);
@@ -96,11 +103,20 @@ class Value
 		
 	private:
 		void     init();
-		
+
+		/// The QString in the storage, only valid when the type is String
+		QString&       stringData()       { return *reinterpret_cast<QString*>(m_storage); }
+		const QString& stringData() const { return *reinterpret_cast<const QString*>(m_storage); }
+
+		/// Destroys the QString in the storage when the type is String, the type has to be set after this
+		void     releaseString() { if (m_type == String) stringData().~QString(); }
+
+		union {
+			bool     m_bool;
+			double   m_double;
+			char     m_storage[sizeof(QString)];  // holds a QString when the type is String
+		};
 		int      m_type;
-		bool     m_bool;
-		double   m_double;
-		QString  m_string;
 };
 
 #endif  // _VALUE_H_
@@ -0,0 +1,50 @@
+/*
+	Copyright (C) 2026 agent <agent AT local>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public
+	License as published by the Free Software Foundation; either
+	version 2 of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to the Free
+	Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+	Boston, MA 02110-1301, USA.
+*/
+
+#include "linebatch.h"
+
+#include <QPainter>
+
+
+LineBatch::LineBatch(const QPen& pen)
+	: m_pen(pen)
+{
+}
+
+void LineBatch::appendLine(const QLineF& line)
+{
+	// leave room for the width of the pen and its square caps
+	const qreal margin = m_pen.widthF();
+	QRectF rect = QRectF(line.p1(), line.p2()).normalized().adjusted(-margin, -margin, margin, margin);
+
+	if (!m_boundingRect.contains(rect)) {
+		prepareGeometryChange();
+		m_boundingRect = m_lines.isEmpty() ? rect : m_boundingRect.united(rect);
+	}
+	m_lines.append(line);
+	update(rect);
+}
+
+void LineBatch::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+	Q_UNUSED(option);
+	Q_UNUSED(widget);
+	painter->setPen(m_pen);
+	painter->drawLines(m_lines);
+}
@@ -0,0 +1,55 @@
+/*
+	Copyright (C) 2026 agent <agent AT local>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public
+	License as published by the Free Software Foundation; either
+	version 2 of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to the Free
+	Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+	Boston, MA 02110-1301, USA.
+*/
+
+#ifndef _LINEBATCH_H_
+#define _LINEBATCH_H_
+
+#include <QGraphicsItem>
+#include <QPen>
+#include <QVector>
+
+
+/**
+ * @short A run of line segments drawn with the same pen, as one scene item.
+ *
+ * The Canvas appends the segments drawn by forward and backward to the
+ * current LineBatch instead of adding a QGraphicsLineItem for each of them.
+ * Every segment is painted as a separate line (with its own caps), so the
+ * result looks exactly like the separate line items did.
+ */
+class LineBatch : public QGraphicsItem
+{
+	public:
+		explicit LineBatch(const QPen& pen);
+
+		const QPen& pen() const { return m_pen; }
+		int segmentCount() const { return m_lines.size(); }
+
+		void appendLine(const QLineF& line);
+
+		QRectF boundingRect() const Q_DECL_OVERRIDE { return m_boundingRect; }
+		void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = nullptr) Q_DECL_OVERRIDE;
+
+	private:
+		QPen            m_pen;
+		QVector<QLineF> m_lines;
+		QRectF          m_boundingRect;
+};
+
+#endif  // _LINEBATCH_H_
@@ -21,6 +21,7 @@
 #include <iostream>
 
 #include <QFile>
+#include <QFileInfo>
 #include <QDebug>
 #include <QApplication>
 #include <KAboutData>
@@ -31,6 +32,7 @@
 #include <Kdelibs4ConfigMigrator>
 
 #include "mainwindow.h"  // for gui mode
+#include "renderer.h"    // for render mode
 
 #include "interpreter/interpreter.h"  // for non gui mode
 #include "interpreter/echoer.h"
@@ -44,11 +46,59 @@ static const char version[]   = "0.8.1 beta";
 static const char copyright[] = "(c) 2003-2009 Cies Breijs";
 static const char website[]   = "http://edu.kde.org/kturtle";
 
+// default resource limits of the testing and render mode, zero means unlimited
+static const int DEFAULT_MAX_TIME       = 60000;  // msecs
+
+// exit codes of the command line modes, so batch jobs can tell why a script stopped
+enum ExitCode {
+	ExitSuccess        = 0,
+	ExitFailure        = 1,  // bad arguments or unreadable files
+	ExitScriptError    = 2,  // the script has errors
+	ExitStepLimit      = 3,
+	ExitTimeLimit      = 4,
+	ExitCallDepthLimit = 5,
+	ExitSegmentLimit   = 6
+};
+
+static int limitToExitCode(int limit)
+{
+	switch (limit) {
+		case Interpreter::StepLimit:      return ExitStepLimit;
+		case Interpreter::TimeLimit:      return ExitTimeLimit;
+		case Interpreter::CallDepthLimit: return ExitCallDepthLimit;
+		case Interpreter::SegmentLimit:   return ExitSegmentLimit;
+	}
+	return ExitSuccess;
+}
+
+static Interpreter::Limits limitsFromCommandLine(const QCommandLineParser& parser)
+{
+	Interpreter::Limits limits;
+	limits.steps     = parser.value("max-steps").toULongLong();
+	limits.msecs     = parser.value("max-time").toInt();
+	limits.callDepth = parser.value("max-call-depth").toInt();
+	limits.segments  = parser.value("max-segments").toULongLong();
+	if (parser.isSet("unlimited")) {
+		limits.steps     = 0;
+		limits.msecs     = 0;
+		limits.callDepth = 0;
+		limits.segments  = 0;
+	}
+	return limits;
+}
+
 
 int main(int argc, char* argv[])
 {
 	KLocalizedString::setApplicationDomain("kturtle");
 
+	// rendering needs no display, so use the offscreen platform unless another one is asked for
+	for (int i = 1; i < argc; i++) {
+		if ((qstrcmp(argv[i], "-r") == 0 || qstrcmp(argv[i], "--render") == 0 || qstrncmp(argv[i], "--render=", 9) == 0) &&
+		    qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+			qputenv("QT_QPA_PLATFORM", "offscreen");
+	}
+
 	QApplication app(argc, argv);
 	app.setAttribute(Qt::AA_UseHighDpiPixmaps, true);
 
@@ -83,13 +133,24 @@ int main(int argc, char* argv[])
 	parser.addOption(QCommandLineOption(QStringList() << QLatin1String("d") << QLatin1String("dbus"), i18n("Starts KTurtle in D-Bus mode (without a GUI), good for automated unit test scripts")));
 	parser.addOption(QCommandLineOption(QStringList() << QLatin1String("t") << QLatin1String("test"), i18n("Starts KTurtle in testing mode (without a GUI), directly runs the specified local file"), QLatin1String("file")));
 	parser.addOption(QCommandLineOption(QStringList() << QLatin1String("l") << QLatin1String("lang"), i18n("Specifies the localization language by a language code, defaults to \"en_US\" (only works in testing mode)"), QLatin1String("code")));
+	parser.addOption(QCommandLineOption(QStringList() << QLatin1String("r") << QLatin1String("render"), i18n("Renders the file specified with --test to a PNG or SVG image instead of echoing its commands; when --test specifies a directory all .turtle files in it are rendered to the output directory"), QLatin1String("output file or directory")));
+	parser.addOption(QCommandLineOption(QStringList() << QLatin1String("f") << QLatin1String("format"), i18n("Image format for --render, \"png\" or \"svg\" (defaults to the extension of the output file, or \"png\" for directories)"), QLatin1String("format")));
+	parser.addOption(QCommandLineOption(QStringList() << QLatin1String("max-steps"), i18n("Aborts the script in testing or render mode after executing this many steps, 0 means no limit (default: 0)"), QLatin1String("steps"), QLatin1String("0")));
+	parser.addOption(QCommandLineOption(QStringList() << QLatin1String("max-time"), i18n("Aborts the script in testing or render mode after running this many milliseconds, 0 means no limit (default: %1)", DEFAULT_MAX_TIME), QLatin1String("msecs"), QString::number(DEFAULT_MAX_TIME)));
+	parser.addOption(QCommandLineOption(QStringList() << QLatin1String("max-call-depth"), i18n("Aborts the script in testing or render mode when this many learned functions are called within each other, 0 means no limit (default: %1)", Interpreter::DEFAULT_MAX_CALL_DEPTH), QLatin1String("calls"), QString::number(Interpreter::DEFAULT_MAX_CALL_DEPTH)));
+	parser.addOption(QCommandLineOption(QStringList() << QLatin1String("max-segments"), i18n("Aborts the script in testing or render mode after drawing this many lines, 0 means no limit (default: 0)"), QLatin1String("lines"), QLatin1String("0")));
+	parser.addOption(QCommandLineOption(QStringList() << QLatin1String("unlimited"), i18n("Removes all limits of the testing and render mode")));
+	parser.addOption(QCommandLineOption(QStringList() << QLatin1String("c") << QLatin1String("compile"), i18n("Compiles the code to bytecode before executing it (only works in testing, render and D-Bus mode)")));
+	parser.addOption(QCommandLineOption(QStringList() << QLatin1String("no-optimize"), i18n("Executes the code as it is parsed, without folding constant expressions, dropping dead branches and specializing numeric arithmetic first (only works in testing, render and D-Bus mode)")));
+	parser.addOption(QCommandLineOption(QStringList() << QLatin1String("inline"), i18n("Expands the calls to small learned functions at their call sites before executing (only works in testing, render and D-Bus mode)")));
+	parser.addOption(QCommandLineOption(QStringList() << QLatin1String("no-memoize"), i18n("Executes every call of a learned function, instead of reusing the results of pure functions called with the same arguments before (only works in testing, render and D-Bus mode)")));
 // 	parser.addOption(QCommandLineOption(QStringList() << QLatin1String("k") << QLatin1String("tokenize"), i18n("Only tokenizes the turtle code (only works in testing mode)")));
 	parser.addOption(QCommandLineOption(QStringList() << QLatin1String("p") << QLatin1String("parse"), i18n("Translates turtle code to embeddable C++ example strings (for developers only)"), QLatin1String("file")));
 
 	parser.process(app);
 	aboutData.processCommandLine(&parser);
 
-	if (!parser.isSet("test") && !parser.isSet("parse") && !parser.isSet("dbus")) {
+	if (!parser.isSet("test") && !parser.isSet("parse") && !parser.isSet("dbus") && !parser.isSet("render")) {
 
 		///////////////// run in GUI mode /////////////////
 		if (app.isSessionRestored()) {
@@ -106,7 +167,11 @@ int main(int argc, char* argv[])
 
 		///////////////// run in DBUS mode /////////////////
 		Translator::instance()->setLanguage();
-		new Interpreter(nullptr, true);
+		Interpreter* interpreter = new Interpreter(nullptr, true);
+		interpreter->setCompiling(parser.isSet("compile"));
+		interpreter->setOptimizing(!parser.isSet("no-optimize"));
+		interpreter->setInlining(parser.isSet("inline"));
+		interpreter->setMemoizing(!parser.isSet("no-memoize"));
 		
 		return app.exec();
 
@@ -128,18 +193,60 @@ int main(int argc, char* argv[])
 
 		const QStringList defaultLooks(Translator::instance()->allDefaultLooks());
 		QString result;
-		Token* t;
-		while ((t = tokenizer.getToken())->type() != Token::EndOfInput) {
-			if (defaultLooks.contains(t->look()))
-				result.append(QString("@(%1)").arg(t->look()));
+		TokenView view;
+		while (tokenizer.scan(view)) {
+			const QString look = tokenizer.look(view);
+			if (defaultLooks.contains(look))
+				result.append(QString("@(%1)").arg(look));
 			else
-				result.append(t->look());
-			if (t->type() == Token::EndOfLine) result.append('\n');
+				result.append(look);
+			if (view.type == Token::EndOfLine) result.append('\n');
 		}
 
 		foreach (const QString &line, result.split('\n')) std::cout << qPrintable(QString("\"%1\"").arg(line)) << std::endl;
 		std::cout << std::endl;
 
+	} else if (parser.isSet("render")) {
+
+		///////////////// run in RENDER mode /////////////////
+		if (!parser.isSet("test")) {
+			std::cout << "Specify the script or directory of scripts to render with --test." << std::endl;
+			return ExitFailure;
+		}
+
+		if (parser.isSet("lang")) {
+			if (!Translator::instance()->setLanguage(parser.value("lang"))) {
+				std::cout << "Could not set localization to: " << qPrintable(parser.value("lang")) << std::endl;
+				return ExitFailure;
+			}
+		} else {
+			Translator::instance()->setLanguage();
+		}
+
+		// an unknown format would be written as PNG under the wrong name
+		const QString format = parser.isSet("format") ? parser.value("format")
+		                     : QFileInfo(parser.value("test")).isDir() ? QString("png")
+		                     : QFileInfo(parser.value("render")).suffix();
+		if (!Renderer::isSupportedFormat(format)) {
+			std::cout << "Unsupported image format: " << qPrintable(format) << ", use png or svg." << std::endl;
+			return ExitFailure;
+		}
+
+		Renderer renderer;
+		renderer.setLimits(limitsFromCommandLine(parser));
+		renderer.setCompiling(parser.isSet("compile"));
+		renderer.setOptimizing(!parser.isSet("no-optimize"));
+		renderer.setInlining(parser.isSet("inline"));
+		renderer.setMemoizing(!parser.isSet("no-memoize"));
+		if (QFileInfo(parser.value("test")).isDir()) {
+			int failed = renderer.renderDirectory(parser.value("test"), parser.value("render"), format);
+			if (failed < 0) return ExitFailure;
+			return failed == 0 ? ExitSuccess : ExitScriptError;
+		}
+		if (renderer.render(parser.value("test"), parser.value("render"), format))
+			return ExitSuccess;
+		return renderer.exceededLimit() != Interpreter::NoLimit ? limitToExitCode(renderer.exceededLimit()) : ExitScriptError;
+
 	} else {
 
 		///////////////// run without a gui /////////////////
@@ -203,24 +310,32 @@ int main(int argc, char* argv[])
 
 		// init the interpreter
 		Interpreter* interpreter = new Interpreter(nullptr, true);  // set testing to true
+		interpreter->setCompiling(parser.isSet("compile"));
+		interpreter->setOptimizing(!parser.isSet("no-optimize"));
+		interpreter->setInlining(parser.isSet("inline"));
+		interpreter->setMemoizing(!parser.isSet("no-memoize"));
+		interpreter->setLimits(limitsFromCommandLine(parser));
 		interpreter->initialize(localizedScript);
 
 		// install the echoer
 		(new Echoer())->connectAllSlots(interpreter->getExecuter());
 
-		// the actual execution (limited to a certain amount of iterations to break endless loops)
-		static const int MAX_ITERATION_STEPS = 20000;
-		int i;
-		for (i = 0;
-		     interpreter->state() != Interpreter::Finished &&
-		     interpreter->state() != Interpreter::Aborted  &&
-		     interpreter->getErrorList()->isEmpty() &&
-		     i < MAX_ITERATION_STEPS;
-		     i++)
-			interpreter->interpret();
-
-		if (i == MAX_ITERATION_STEPS)
-			std::cout << "ERR> Iterated more than " << MAX_ITERATION_STEPS << " steps... Execution terminated." << std::endl;
+		// the actual execution (the limits break endless loops)
+		while (interpreter->state() != Interpreter::Finished &&
+		       interpreter->state() != Interpreter::Aborted  &&
+		       interpreter->getErrorList()->isEmpty()) {
+			if (interpreter->getExecuter()->isWaiting())
+				QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);  // for the 'wait' command
+			else
+				interpreter->interpret();
+		}
+
+		if (interpreter->exceededLimit() != Interpreter::NoLimit) {
+			std::cout << "ERR> Exceeded " << qPrintable(interpreter->exceededLimitString()) << "... Execution terminated." << std::endl;
+			return limitToExitCode(interpreter->exceededLimit());
+		}
+		if (interpreter->encounteredErrors())
+			return ExitScriptError;
 
 	}
 
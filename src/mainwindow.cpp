@@ -54,6 +54,8 @@
 
 static const int MARGIN_SIZE = 3;  // defaultly styled margins look shitty
 static const char* const GHNS_TARGET = "kturtle/examples";
+static const int DEFAULT_TIME_SLICE = 8;  // msecs, leaves room for a repaint within a 60Hz frame
+static const int PREPARE_DELAY = 1000;  // msecs without edits before the code is parsed for the next run
 
 MainWindow::MainWindow()
 {
@@ -66,6 +68,11 @@ MainWindow::MainWindow()
 
 	iterationTimer = new QTimer(this);
 	connect(iterationTimer, &QTimer::timeout, this, &MainWindow::iterate);
+	timeSlice = DEFAULT_TIME_SLICE;
+
+	prepareTimer = new QTimer(this);
+	prepareTimer->setSingleShot(true);
+	connect(prepareTimer, &QTimer::timeout, this, &MainWindow::prepareRun);
 
 	connect(editor, &Editor::contentChanged, inspector, &Inspector::disable);
 	connect(editor, &Editor::contentChanged, errorDialog, &ErrorDialog::disable);
@@ -307,6 +314,13 @@ void MainWindow::setupActions()
 	printCanvasAct->setWhatsThis(i18n("Print: Print the canvas"));
 	connect(printCanvasAct, &QAction::triggered, this, &MainWindow::canvasPrintDialog);
 
+	rasterCanvasAct = new QAction(i18n("Draw on a &Raster"), this);
+	actionCollection()->addAction("canvas_raster_mode", rasterCanvasAct);
+	rasterCanvasAct->setStatusTip(i18n("Paint the drawing on an image, which uses much less memory for huge drawings, lines outside the canvas are not kept"));
+	rasterCanvasAct->setWhatsThis(i18n("Draw on a Raster: Paint the drawing on an image instead of keeping every line, which uses much less memory for programs that draw a lot. Only the part of the drawing that lies on the canvas is kept. Switching it on paints the current drawing on the image, switching it off clears the canvas. It cannot be switched while a program runs."));
+	rasterCanvasAct->setCheckable(true);
+	rasterCanvasAct->setChecked(false);  // connected to the canvas in setupCanvas()
+
 	// Run menu actions
 	runAct = new QAction(QIcon::fromTheme("media-playback-start"), i18n("&Run"), this);
 	actionCollection()->addAction("run", runAct);
@@ -507,6 +521,7 @@ void MainWindow::setupCanvas()
 	canvas->setFocusPolicy(Qt::NoFocus);
 	canvas->setRenderHint(QPainter::Antialiasing);
 	canvas->setWhatsThis(i18n("Canvas: This is where the turtle moves and draws when the program is running"));
+	connect(rasterCanvasAct, &QAction::toggled, canvas, &Canvas::setRasterMode);
 	canvasLayout->addWidget(canvas);
         canvasLayout->setMargin(0);
 	canvasTabWidget->insertTab(0, canvasTab, i18n("&Canvas"));
@@ -578,6 +593,10 @@ void MainWindow::setupDockWindows()
 void MainWindow::setupEditor()
 {
 // 	editor->setTranslator(Translator::instance());
+	// finds the errors on a worker thread while the code is edited
+	analyzer = new Analyzer(this);
+	connect(editor, &Editor::linesChanged, analyzer, &Analyzer::changeLines);
+	connect(analyzer, &Analyzer::analyzed, this, &MainWindow::showAnalysis);
 	connect(editor, &Editor::modificationChanged, this, &MainWindow::updateModificationState);
 	connect(editor, &Editor::contentNameChanged, this, &MainWindow::updateContentName);
 	connect(editor, &Editor::fileOpened, this, &MainWindow::addToRecentFilesList);
@@ -589,6 +608,8 @@ void MainWindow::setupInterpreter()
 {
 	interpreter = new Interpreter(this, false);
 	connect(interpreter, &Interpreter::finished, this, &MainWindow::abort);
+	connect(interpreter, &Interpreter::parsed, this, &MainWindow::parsedInBackground);
+	connect(interpreter, &Interpreter::parseProgress, this, &MainWindow::showParseProgress);
 	Executer* executer = interpreter->getExecuter();
 
 	// the code to connect the executer with the canvas is auto generated:
@@ -637,6 +658,10 @@ void MainWindow::setupStatusBar()
 	statusBar()->addPermanentWidget(statusBarFileNameLabel, 0);
 	statusBarFileNameLabel->setAlignment(Qt::AlignRight);
 
+	statusBarErrorLabel = new QLabel(statusBar());
+	statusBar()->addPermanentWidget(statusBarErrorLabel, 0);
+	statusBarErrorLabel->setAlignment(Qt::AlignRight);
+
 	toggleOverwriteMode(false);
 	updateOnCursorPositionChange();
 }
@@ -818,11 +843,21 @@ bool MainWindow::setCurrentLanguage(const QString &lang_code)  // 2 or 5 digit c
 {
 	bool result = false;
 	//qDebug() << "MainWindow::setCurrentLanguage: " << lang_code;
+	analyzer->stop();  // it uses the dictionary that is replaced
+	editor->waitForLoading();  // and so does the loading of a large file
+	prepareTimer->stop();  // and the parsing on the worker thread of the interpreter
+	if (interpreter->isParsingInBackground()) {
+		if (interpreter->state() == Interpreter::Parsing)
+			abort();  // the run can not go on with the old dictionary
+		else
+			interpreter->stopParsing();  // the parse ahead of the next run, see prepareRun()
+	}
 	if (Translator::instance()->setLanguage(lang_code)) {
 		currentLanguageCode = lang_code;
 		statusBarLanguageLabel->setText(' ' + codeToFullName(lang_code) + ' ');
 		updateExamplesMenu();
 		editor->rehighlight();
+		analyzer->setCode(editor->content());
 		result = true;
 	} else {
 		KMessageBox::error(this, i18n("Could not change the language to %1.", codeToFullName(lang_code)));
@@ -849,11 +884,18 @@ void MainWindow::run()
 		inspector->clear();
 		errorDialog->clear();
 		showErrorDialog(false);
+		// the slower speeds are there to see every step, so only optimize when running at full speed
+		interpreter->setOptimizing(runSpeed == 0);
+		interpreter->setMemoizing(runSpeed == 0);
+		// parse on a worker thread to keep the GUI responsive, except when stepping
+		// where statements are parsed (and shown) one at a time
+		interpreter->setParseMode(runSpeed == 5 ? Interpreter::ParseStatements : Interpreter::ParseInBackground);
 		interpreter->initialize(editor->content());
 	}
 	editor->disable();
 	console->disable();
 	executeConsoleAct->setEnabled(false);
+	rasterCanvasAct->setEnabled(false);  // switching clears or converts the drawing
 	toggleGuiFeedback(runSpeed != 0);
 
 	// start parsing (always in full speed)
@@ -876,6 +918,8 @@ QString MainWindow::execute(const QString &operation)
 	if (interpreter->state() == Interpreter::Uninitialized ||
 	    interpreter->state() == Interpreter::Finished ||
 	    interpreter->state() == Interpreter::Aborted) {
+		inspector->updateTree(nullptr);  // the tree of the previous run is released
+		interpreter->setParseMode(Interpreter::ParseAll);
 		interpreter->initialize(operation);
 	}
 
@@ -943,7 +987,54 @@ void MainWindow::iterate()
 				return;
 		}
 	}
-	interpreter->interpret();
+
+	if (runSpeed == 0) {
+		// nothing to show in between steps, so run as many as fit in a time slice
+		// before giving the event loop a chance to repaint and handle an abort
+		interpreter->interpretFor(timeSlice);
+	} else {
+		interpreter->interpret();
+	}
+
+	// the timer is restarted when the worker thread has parsed the code
+	if (interpreter->isParsingInBackground())
+		iterationTimer->stop();
+}
+
+void MainWindow::parsedInBackground()
+{
+	statusBar()->clearMessage();
+	if (!pauseAct->isChecked())
+		iterationTimer->start(0);
+}
+
+void MainWindow::showParseProgress(int percent)
+{
+	statusBar()->showMessage(i18nc("@info:status the code is being parsed", "Parsing... %1%", percent));
+}
+
+void MainWindow::showAnalysis()
+{
+	ErrorList errors = analyzer->errors();
+	if (errors.isEmpty()) {
+		statusBarErrorLabel->clear();
+		prepareTimer->start(PREPARE_DELAY);
+		return;
+	}
+	prepareTimer->stop();
+	const ErrorMessage& error = errors.first();
+	statusBarErrorLabel->setText(' ' + i18ncp("@info:status the errors found in the code while it is edited",
+		"Line %2: %3", "%1 errors, the first on line %2: %3",
+		errors.size(), error.token().startRow(), error.text()) + ' ');
+}
+
+void MainWindow::prepareRun()
+{
+	if (runSpeed == 5) return;  // stepping parses (and shows) the statements one at a time
+	// the same passes as run() asks for, so the prepared tree is the one the run will use
+	interpreter->setOptimizing(runSpeed == 0);
+	interpreter->setMemoizing(runSpeed == 0);
+	interpreter->prepare(editor->content());
 }
 
 void MainWindow::pause()
@@ -951,6 +1042,7 @@ void MainWindow::pause()
 	if (pauseAct->isChecked()) {
 		runAct->setEnabled(true);
 		iterationTimer->stop();
+		inspector->flush();  // show the exact state while paused
 		return;
 	}
 	iterate();
@@ -959,9 +1051,12 @@ void MainWindow::pause()
 void MainWindow::abort()
 {
 	iterationTimer->stop();
+	if (interpreter->isParsingInBackground())
+		statusBar()->clearMessage();
 	interpreter->abort();
 
 	editor->removeMarkings();
+	inspector->flush();
 	inspector->clearAllMarks();
 
 	runAct->setEnabled(true);
@@ -972,6 +1067,7 @@ void MainWindow::abort()
 	editor->enable();
 	console->enable();
 	executeConsoleAct->setEnabled(true);
+	rasterCanvasAct->setEnabled(true);
 
 	if (interpreter->encounteredErrors()) {
 		errorDialog->setErrorList(interpreter->getErrorList());
@@ -1004,6 +1100,11 @@ void MainWindow::readConfig()
 	QString lang_code(config.readEntry("currentLanguageCode", QVariant(QString())).toString());
 	if (lang_code.isEmpty()) lang_code = "en_US";  // null-string are saved as empty-strings
 	setCurrentLanguage(lang_code);
+	timeSlice = qMax(1, config.readEntry("dedicatedSpeedTimeSlice", DEFAULT_TIME_SLICE));
+	rasterCanvasAct->setChecked(config.readEntry("rasterCanvas", false));
+	Interpreter::Limits limits = interpreter->limits();
+	limits.callDepth = qMax(0, config.readEntry("maxCallDepth", limits.callDepth));  // 0 means unlimited
+	interpreter->setLimits(limits);
 // 	if(m_paShowStatusBar->isChecked())
 // 		statusBar()->show();
 // 	else
@@ -1017,6 +1118,9 @@ void MainWindow::writeConfig()
 // 	config.writeEntry("ShowPath",m_paShowPath->isChecked());
 	recentFilesAction->saveEntries(KSharedConfig::openConfig()->group( "Recent Files"));
 	config.writeEntry("currentLanguageCode", currentLanguageCode);
+	config.writeEntry("dedicatedSpeedTimeSlice", timeSlice);
+	config.writeEntry("rasterCanvas", rasterCanvasAct->isChecked());
+	config.writeEntry("maxCallDepth", interpreter->limits().callDepth);
 	config.sync();
 }
 
@@ -24,6 +24,7 @@
 
 #include <KXmlGuiWindow>
 
+#include "interpreter/analyzer.h"
 #include "interpreter/interpreter.h"
 #include "canvas.h"
 #include "colorpicker.h"
@@ -87,6 +88,10 @@ class MainWindow : public KXmlGuiWindow
 		void pause();
 		void abort();
 		void iterate();
+		void parsedInBackground();
+		void showParseProgress(int percent);
+		void showAnalysis();
+		void prepareRun();
 		QString execute(const QString&);  // for single command execution as by the console
 		void setDedicatedSpeed() { setRunSpeed(0); }
 		void setFullSpeed()      { setRunSpeed(1); }
@@ -134,6 +139,7 @@ class MainWindow : public KXmlGuiWindow
 		Console         *console;
 		Editor          *editor;
 		Interpreter     *interpreter;
+		Analyzer        *analyzer;
 		Inspector       *inspector;
 		ErrorDialog     *errorDialog;
 		DirectionDialog *directionDialog;
@@ -144,7 +150,9 @@ class MainWindow : public KXmlGuiWindow
 		LocalDockWidget *editorDock;
 		LocalDockWidget *inspectorDock;
 		QTimer          *iterationTimer;
+		QTimer          *prepareTimer;  // parses the code once the edits settle, see Interpreter::prepare()
 		int              runSpeed;
+		int              timeSlice;  // msecs of interpreting per event-loop iteration at dedicated speed
 		bool             currentlyRunningConsole;
 
 		QString currentLanguageCode;
@@ -164,6 +172,7 @@ class MainWindow : public KXmlGuiWindow
 		QAction *exportToSvgAct;
 		QAction *exportToHtmlAct;
 		QAction *printCanvasAct;
+		QAction *rasterCanvasAct;
 		QAction *runAct;
 		QAction *pauseAct;
 		QAction *abortAct;
@@ -185,6 +194,7 @@ class MainWindow : public KXmlGuiWindow
 		QLabel *statusBarPositionLabel;
 		QLabel *statusBarOverwriteModeLabel;
 		QLabel *statusBarFileNameLabel;
+		QLabel *statusBarErrorLabel;
 };
 
 #endif  // _MAINWINDOW_H_
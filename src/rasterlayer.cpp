@@ -0,0 +1,135 @@
+/*
+	Copyright (C) 2026 agent <agent AT local>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public
+	License as published by the Free Software Foundation; either
+	version 2 of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to the Free
+	Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+	Boston, MA 02110-1301, USA.
+*/
+
+#include "rasterlayer.h"
+
+#include <cmath>
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
+
+const int kTileSize = 256;
+
+
+RasterLayer::RasterLayer(const QRectF& rect)
+	: m_rect(rect)
+{
+	setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+void RasterLayer::setRect(const QRectF& rect)
+{
+	prepareGeometryChange();
+	m_rect = rect;
+
+	QHash<TileIndex, QImage>::iterator i = tiles.begin();
+	while (i != tiles.end()) {
+		QRectF tileRect(i.key().first * kTileSize, i.key().second * kTileSize, kTileSize, kTileSize);
+		if (tileRect.intersects(m_rect))
+			++i;
+		else
+			i = tiles.erase(i);
+	}
+}
+
+void RasterLayer::clear()
+{
+	tiles.clear();
+	update();
+}
+
+QList<RasterLayer::TileIndex> RasterLayer::tilesIn(const QRectF& area) const
+{
+	QList<TileIndex> result;
+	QRectF clipped = area.intersected(m_rect);
+	if (clipped.isEmpty()) return result;
+
+	int left   = static_cast<int>(std::floor(clipped.left()   / kTileSize));
+	int right  = static_cast<int>(std::floor(clipped.right()  / kTileSize));
+	int top    = static_cast<int>(std::floor(clipped.top()    / kTileSize));
+	int bottom = static_cast<int>(std::floor(clipped.bottom() / kTileSize));
+	for (int x = left; x <= right; x++)
+		for (int y = top; y <= bottom; y++)
+			result.append(TileIndex(x, y));
+	return result;
+}
+
+void RasterLayer::beginTile(QPainter* painter, const TileIndex& index)
+{
+	QHash<TileIndex, QImage>::iterator tile = tiles.find(index);
+	if (tile == tiles.end()) {
+		QImage image(kTileSize, kTileSize, QImage::Format_ARGB32_Premultiplied);
+		image.fill(Qt::transparent);
+		tile = tiles.insert(index, image);
+	}
+	painter->begin(&tile.value());
+	painter->setRenderHint(QPainter::Antialiasing);  // antialiasing like our Canvas
+	painter->translate(-index.first * kTileSize, -index.second * kTileSize);
+}
+
+void RasterLayer::drawLine(const QLineF& line, const QPen& pen)
+{
+	// leave room for the width of the pen, its square caps and the antialiasing
+	const qreal margin = pen.widthF() + 1;
+	QRectF area = QRectF(line.p1(), line.p2()).normalized().adjusted(-margin, -margin, margin, margin);
+
+	foreach (const TileIndex& index, tilesIn(area)) {
+		QPainter painter;
+		beginTile(&painter, index);
+		painter.setPen(pen);
+		painter.drawLine(line);
+		painter.end();
+	}
+	update(area);
+}
+
+void RasterLayer::drawItem(QGraphicsItem* item)
+{
+	QRectF area = item->sceneBoundingRect();
+	QStyleOptionGraphicsItem option;
+	option.exposedRect = item->boundingRect();
+
+	foreach (const TileIndex& index, tilesIn(area)) {
+		QPainter painter;
+		beginTile(&painter, index);
+		painter.setTransform(item->sceneTransform(), true);
+		item->paint(&painter, &option, nullptr);
+		painter.end();
+	}
+	update(area);
+}
+
+void RasterLayer::paintTiles(QPainter* painter, const QRectF& area) const
+{
+	foreach (const TileIndex& index, tilesIn(area)) {
+		QHash<TileIndex, QImage>::const_iterator tile = tiles.constFind(index);
+		if (tile != tiles.constEnd())
+			painter->drawImage(QPointF(index.first * kTileSize, index.second * kTileSize), tile.value());
+	}
+}
+
+void RasterLayer::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+	Q_UNUSED(widget);
+	painter->save();
+	painter->setClipRect(m_rect);  // tiles stick out of the canvas at the right and bottom
+	paintTiles(painter, option->exposedRect);
+	painter->restore();
+}
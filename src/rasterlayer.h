@@ -0,0 +1,73 @@
+/*
+	Copyright (C) 2026 agent <agent AT local>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public
+	License as published by the Free Software Foundation; either
+	version 2 of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to the Free
+	Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+	Boston, MA 02110-1301, USA.
+*/
+
+#ifndef _RASTERLAYER_H_
+#define _RASTERLAYER_H_
+
+#include <QGraphicsItem>
+#include <QHash>
+#include <QImage>
+#include <QPair>
+#include <QPen>
+
+
+/**
+ * @short Keeps the drawing of the Canvas as raster tiles instead of scene items.
+ *
+ * In raster mode the Canvas paints lines and text straight into the tiles of
+ * this item, so the memory used depends on the canvas size and not on the
+ * amount of strokes. Tiles are only made when something is drawn on them,
+ * and only within the canvas rectangle.
+ */
+class RasterLayer : public QGraphicsItem
+{
+	public:
+		explicit RasterLayer(const QRectF& rect);
+
+		/// Sets the canvas rectangle, the tiles outside of it are dropped
+		void setRect(const QRectF& rect);
+
+		void drawLine(const QLineF& line, const QPen& pen);
+
+		/// Paints @p item (like a text item) into the tiles, the item itself is not needed afterwards
+		void drawItem(QGraphicsItem* item);
+
+		/// Removes the drawing
+		void clear();
+
+		/// Paints the tiles that intersect @p area in scene coordinates
+		void paintTiles(QPainter* painter, const QRectF& area) const;
+
+		QRectF boundingRect() const Q_DECL_OVERRIDE { return m_rect; }
+		void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = nullptr) Q_DECL_OVERRIDE;
+
+	private:
+		typedef QPair<int, int> TileIndex;
+
+		/// Points @p painter to the tile, which is made when it does not exist yet
+		void beginTile(QPainter* painter, const TileIndex& index);
+
+		/// @returns the indexes of the tiles in @p area that lie on the canvas
+		QList<TileIndex> tilesIn(const QRectF& area) const;
+
+		QRectF                      m_rect;
+		QHash<TileIndex, QImage>    tiles;
+};
+
+#endif  // _RASTERLAYER_H_
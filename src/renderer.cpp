@@ -0,0 +1,159 @@
+/*
+	Copyright (C) 2026 agent <agent AT local>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public
+	License as published by the Free Software Foundation; either
+	version 2 of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to the Free
+	Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+	Boston, MA 02110-1301, USA.
+*/
+
+#include "renderer.h"
+
+#include <iostream>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QTextStream>
+
+#include "canvas.h"
+#include "editor.h"  // for the magic identifier
+#include "interpreter/translator.h"
+
+
+static const int TIME_SLICE = 100;  // msecs of interpreting per loop, the limits are checked by the interpreter
+
+
+Renderer::Renderer(QObject* parent)
+	: QObject(parent)
+{
+	canvas = new Canvas();
+	interpreter = new Interpreter(this, false);
+	Executer* executer = interpreter->getExecuter();
+
+	// the code to connect the executer with the canvas is auto generated:
+#include "interpreter/gui_connect.inc"
+}
+
+Renderer::~Renderer()
+{
+	delete canvas;
+}
+
+void Renderer::setLimits(const Interpreter::Limits& limits)
+{
+	interpreter->setLimits(limits);
+}
+
+void Renderer::setCompiling(bool compiling)
+{
+	interpreter->setCompiling(compiling);
+}
+
+void Renderer::setOptimizing(bool optimizing)
+{
+	interpreter->setOptimizing(optimizing);
+}
+
+void Renderer::setInlining(bool inlining)
+{
+	interpreter->setInlining(inlining);
+}
+
+void Renderer::setMemoizing(bool memoizing)
+{
+	interpreter->setMemoizing(memoizing);
+}
+
+bool Renderer::isSupportedFormat(const QString& format)
+{
+	const QString lowerFormat = format.toLower();
+	return lowerFormat.isEmpty() || lowerFormat == "png" || lowerFormat == "svg";
+}
+
+int Renderer::exceededLimit() const
+{
+	return interpreter->exceededLimit();
+}
+
+
+bool Renderer::render(const QString& inputFile, const QString& outputFile, const QString& format)
+{
+	QString outputFormat = format.isEmpty() ? QFileInfo(outputFile).suffix().toLower() : format.toLower();
+	if (!isSupportedFormat(outputFormat)) {
+		std::cout << "Unsupported image format: " << qPrintable(outputFormat) << ", use png or svg." << std::endl;
+		return false;
+	}
+
+	QFile file(inputFile);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		std::cout << "Could not open input file: " << qPrintable(inputFile) << std::endl;
+		return false;
+	}
+	QTextStream in(&file);
+	if (in.readLine() != KTURTLE_MAGIC_1_0) {
+		std::cout << qPrintable(inputFile) << ": not a valid KTurtle script, or incompatible with this version of KTurtle." << std::endl;
+		return false;
+	}
+
+	canvas->slotReset();
+	interpreter->initialize(Translator::instance()->localizeScript(in.readAll()));
+
+	while (interpreter->state() != Interpreter::Finished &&
+	       interpreter->state() != Interpreter::Aborted) {
+		if (interpreter->getExecuter()->isWaiting())
+			QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);  // for the 'wait' command
+		else
+			interpreter->interpretFor(TIME_SLICE);
+	}
+
+	if (interpreter->exceededLimit() != Interpreter::NoLimit)
+		std::cout << qPrintable(inputFile) << ": exceeded " << qPrintable(interpreter->exceededLimitString()) << ", execution terminated." << std::endl;
+
+	bool success = !interpreter->encounteredErrors() && interpreter->state() == Interpreter::Finished;
+	foreach (const QString& error, interpreter->getErrorStrings())
+		std::cout << qPrintable(inputFile) << ": " << qPrintable(error) << std::endl;
+
+	bool saved = outputFormat == "svg" ? canvas->saveAsSvg(QFileInfo(inputFile).baseName(), outputFile)
+	                                   : canvas->getPicture().save(outputFile, "PNG");
+	if (!saved) {
+		std::cout << "Could not write output file: " << qPrintable(outputFile) << std::endl;
+		return false;
+	}
+	return success;
+}
+
+
+int Renderer::renderDirectory(const QString& inputDirectory, const QString& outputDirectory, const QString& format)
+{
+	QDir input(inputDirectory);
+	QDir output(outputDirectory);
+	if (!output.exists() && !output.mkpath(".")) {
+		std::cout << "Could not create output directory: " << qPrintable(outputDirectory) << std::endl;
+		return -1;
+	}
+
+	if (!isSupportedFormat(format)) {
+		std::cout << "Unsupported image format: " << qPrintable(format) << ", use png or svg." << std::endl;
+		return -1;
+	}
+	const QString suffix = format.toLower() == "svg" ? "svg" : "png";
+	int failed = 0;
+	foreach (const QFileInfo& script, input.entryInfoList(QStringList() << "*.turtle", QDir::Files, QDir::Name)) {
+		QString outputFile = output.filePath(script.completeBaseName() + '.' + suffix);
+		if (!render(script.filePath(), outputFile, suffix)) failed++;
+	}
+	return failed;
+}
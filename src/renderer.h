@@ -0,0 +1,92 @@
+/*
+	Copyright (C) 2026 agent <agent AT local>
+
+	This program is free software; you can redistribute it and/or
+	modify it under the terms of the GNU General Public
+	License as published by the Free Software Foundation; either
+	version 2 of the License, or (at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public
+	License along with this program; if not, write to the Free
+	Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+	Boston, MA 02110-1301, USA.
+*/
+
+#ifndef _RENDERER_H_
+#define _RENDERER_H_
+
+#include <QObject>
+#include <QString>
+
+#include "interpreter/interpreter.h"
+
+class Canvas;
+
+
+/**
+ * @short Runs scripts on an offscreen Canvas and saves the picture, without a GUI.
+ *
+ * Used by the --render command line mode. Unlike the --test mode no Echoer is
+ * connected, the output is the picture (PNG or SVG) only. One Renderer can
+ * render many scripts, which is what renderDirectory() does.
+ */
+class Renderer : public QObject
+{
+	Q_OBJECT
+
+	public:
+		explicit Renderer(QObject* parent = nullptr);
+		~Renderer();
+
+		/// Sets the resource limits for each script, see Interpreter::setLimits()
+		void setLimits(const Interpreter::Limits& limits);
+
+		/// Sets whether the scripts are compiled to bytecode before they are executed, see Interpreter::setCompiling()
+		void setCompiling(bool compiling);
+
+		/// Sets whether the scripts are optimized before they are executed, see Interpreter::setOptimizing()
+		void setOptimizing(bool optimizing);
+
+		/// Sets whether the calls to small learned functions are inlined, see Interpreter::setInlining()
+		void setInlining(bool inlining);
+
+		/// Sets whether the results of pure learned functions are reused, see Interpreter::setMemoizing()
+		void setMemoizing(bool memoizing);
+
+		/// @returns the Interpreter::Limit that aborted the last script, Interpreter::NoLimit if none did
+		int exceededLimit() const;
+
+		/**
+		 * Runs the script in @p inputFile and saves the canvas to @p outputFile.
+		 * @param format "png" or "svg", when empty it follows the extension of @p outputFile,
+		 *        and is "png" when that has none
+		 * @returns TRUE when the script ran without errors and the picture was saved
+		 */
+		bool render(const QString& inputFile, const QString& outputFile, const QString& format = QString());
+
+		/**
+		 * Renders every .turtle file in @p inputDirectory to a file with the same
+		 * base name in @p outputDirectory.
+		 * @returns the number of scripts that failed
+		 */
+		int renderDirectory(const QString& inputDirectory, const QString& outputDirectory, const QString& format = QString("png"));
+
+		/// @returns TRUE when @p format (like "png", "svg" or empty) can be rendered to
+		static bool isSupportedFormat(const QString& format);
+
+	private slots:
+		// the executer asks for these, there is nobody to show them to
+		void slotMessageDialog(const QString&) {}
+		void slotInputDialog(QString&) {}
+
+	private:
+		Canvas      *canvas;
+		Interpreter *interpreter;
+};
+
+#endif  // _RENDERER_H_